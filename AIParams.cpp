@@ -0,0 +1,66 @@
+#include "AIParams.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+const AIParamField AI_PARAM_FIELDS[] = {
+    {"keeper_danger", &AIParams::keeperDangerDepth, 0.10f, 0.30f},
+    {"keeper_alert", &AIParams::keeperAlertDepth, 0.35f, 0.75f},
+    {"defender_danger", &AIParams::defenderDangerDepth, 0.30f, 0.60f},
+    {"defender_alert", &AIParams::defenderAlertDepth, 0.60f, 0.90f},
+    {"attacker_danger", &AIParams::attackerDangerDepth, 0.30f, 0.70f},
+    {"shoot_start", &AIParams::shootingRangeStart, 0.60f, 0.80f},
+    {"shoot_end", &AIParams::shootingRangeEnd, 0.80f, 0.92f},
+    {"high_kick", &AIParams::highKickForce, 12.0f, 22.0f},
+    {"low_kick", &AIParams::lowKickForce, 8.0f, 16.0f},
+    {"keeper_speed", &AIParams::goalKeeperSpeed, 10.0f, 20.0f},
+    {"defender_speed", &AIParams::defenderSpeed, 7.0f, 14.0f},
+    {"attacker_speed", &AIParams::attackerSpeed, 7.0f, 15.0f},
+};
+
+const int AI_PARAM_FIELD_COUNT = sizeof(AI_PARAM_FIELDS) / sizeof(AI_PARAM_FIELDS[0]);
+
+const AIParamField *FindAIParamField(const std::string &name) {
+    for (int i = 0; i < AI_PARAM_FIELD_COUNT; i++) {
+        if (name == AI_PARAM_FIELDS[i].name)
+            return &AI_PARAM_FIELDS[i];
+    }
+    return nullptr;
+}
+
+bool ParseAIParams(const std::string &text, AIParams &params) {
+    std::stringstream stream(text);
+    std::string entry;
+    while (std::getline(stream, entry, ',')) {
+        if (entry.empty())
+            continue;
+
+        size_t separator = entry.find('=');
+        const AIParamField *field = separator == std::string::npos ? nullptr : FindAIParamField(entry.substr(0, separator));
+        if (field == nullptr) {
+            std::cerr << "Unknown AI parameter: " << entry << std::endl;
+            return false;
+        }
+
+        const char *number = entry.c_str() + separator + 1;
+        char *end = nullptr;
+        double value = strtod(number, &end);
+        if (end == number || *end != '\0') {
+            std::cerr << "Invalid value for AI parameter: " << entry << std::endl;
+            return false;
+        }
+        params.*(field->value) = (float)value;
+    }
+    return true;
+}
+
+std::string FormatAIParams(const AIParams &params) {
+    std::stringstream stream;
+    for (int i = 0; i < AI_PARAM_FIELD_COUNT; i++) {
+        if (i > 0)
+            stream << ",";
+        stream << AI_PARAM_FIELDS[i].name << "=" << params.*(AI_PARAM_FIELDS[i].value);
+    }
+    return stream.str();
+}
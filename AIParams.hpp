@@ -0,0 +1,50 @@
+#ifndef AIPARAMS_HPP
+#define AIPARAMS_HPP
+
+#include "Global.hpp"
+
+#include <string>
+
+/*Tuning of one team's AI, the defaults are the hand tuned values.
+Depths are fractions of the pitch width measured from the team's own goal line, mirrored for the right team.
+*/
+struct AIParams {
+    // Keeper rushes out up to the danger depth, tracks the ball up to the alert depth
+    float keeperDangerDepth = 0.20f;
+    float keeperAlertDepth = 0.60f;
+    // Defender runs at the ball up to the alert depth, the danger depth splits its two zones
+    float defenderDangerDepth = 0.50f;
+    float defenderAlertDepth = 0.75f;
+    // Attacker chases the ball past this depth
+    float attackerDangerDepth = 0.50f;
+    // Attacker on the ball shoots from between these depths
+    float shootingRangeStart = 0.75f;
+    float shootingRangeEnd = 0.85f;
+
+    float highKickForce = HIGH_KICK_FORCE;
+    float lowKickForce = LOW_KICK_FORCE;
+
+    float goalKeeperSpeed = GoalKeeperSpeed;
+    float defenderSpeed = DefenderSpeed;
+    float attackerSpeed = AttackerSpeed;
+};
+
+// A tunable value of AIParams and the range a sweep draws it from
+struct AIParamField {
+    const char *name;
+    float AIParams::*value;
+    float min, max;
+};
+
+extern const AIParamField AI_PARAM_FIELDS[];
+extern const int AI_PARAM_FIELD_COUNT;
+
+// Field by name, nullptr if there is none
+const AIParamField *FindAIParamField(const std::string &name);
+
+// Reads "name=value,name=value" over params, fields not named keep their value. False on an unknown name or a value that isn't a number.
+bool ParseAIParams(const std::string &text, AIParams &params);
+// Every field in the form ParseAIParams reads
+std::string FormatAIParams(const AIParams &params);
+
+#endif // AIPARAMS_HPP
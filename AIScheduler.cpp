@@ -0,0 +1,43 @@
+#include "AIScheduler.hpp"
+
+// Upper ball distance of each interval band, beyond the last one agents get MAX_INTERVAL
+static const float BAND_DISTANCES[] = {200.0f, 400.0f, 700.0f};
+static const int BAND_INTERVALS[] = {1, 2, 4};
+static const int BAND_COUNT = sizeof(BAND_DISTANCES) / sizeof(BAND_DISTANCES[0]);
+
+int AIScheduler::AddAgent() {
+    for (size_t i = 0; i < slots.size(); i++) {
+        if (!slots[i]) {
+            slots[i] = true;
+            return (int)i;
+        }
+    }
+    slots.push_back(true);
+    return (int)slots.size() - 1;
+}
+
+void AIScheduler::RemoveAgent(int slot) {
+    if (slot >= 0 && slot < (int)slots.size())
+        slots[slot] = false;
+}
+
+int AIScheduler::GetInterval(AIRole role, float ballDistance, int possession, bool urgent) const {
+    if (urgent)
+        return 1;
+
+    int band = 0;
+    while (band < BAND_COUNT && ballDistance >= BAND_DISTANCES[band])
+        band++;
+
+    bool inPlay = role == AI_ROLE_ATTACKER ? possession > 0 : possession < 0;
+    if (inPlay && band > 0)
+        band--;
+
+    return band < BAND_COUNT ? BAND_INTERVALS[band] : MAX_INTERVAL;
+}
+
+bool AIScheduler::IsDue(int slot, int interval, Uint64 tick) const {
+    if (interval <= 1)
+        return true;
+    return (tick + slot) % interval == 0;
+}
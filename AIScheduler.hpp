@@ -0,0 +1,41 @@
+#ifndef AISCHEDULER_HPP
+#define AISCHEDULER_HPP
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+// What an AI controller does on the pitch, weighed by AIScheduler
+enum AIRole {
+    AI_ROLE_GOALKEEPER,
+    AI_ROLE_DEFENDER,
+    AI_ROLE_ATTACKER
+};
+
+/*Decides how often each AI controller makes a decision, the controller keeps steering the last way in between.
+A player on the ball or with the ball heading into its goal decides every tick, the rest by distance to the
+ball, every 1, 2, 4 or MAX_INTERVAL ticks. Players whose role is in play (attackers while their team has
+the ball, the others while the opponent has it) are bumped up one step.
+Agents hold consecutive slots and one is due when tick + slot is a multiple of its interval, so agents on
+the same interval take turns instead of all deciding on the same tick.
+*/
+class AIScheduler {
+public:
+    static const int MAX_INTERVAL = 8;
+
+private:
+    // Taken slots
+    std::vector<bool> slots;
+
+public:
+    // Lowest free slot
+    int AddAgent();
+    void RemoveAgent(int slot);
+
+    /*Ticks between decisions. possession is 1 while the agent's team has the ball, -1 while the
+    opponent has it and 0 while it is free. urgent forces every tick.
+    */
+    int GetInterval(AIRole role, float ballDistance, int possession, bool urgent) const;
+    bool IsDue(int slot, int interval, Uint64 tick) const;
+};
+
+#endif // AISCHEDULER_HPP
@@ -0,0 +1,206 @@
+#include "AssetArchive.hpp"
+#include "Profiler.hpp"
+
+#include <cctype>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+AssetArchive *AssetArchive::instance = nullptr;
+
+AssetArchive::AssetArchive() {
+}
+
+AssetArchive::~AssetArchive() {
+    Unmap();
+    instance = nullptr;
+}
+
+AssetArchive *AssetArchive::GetInstance() {
+    if (instance == nullptr) {
+        instance = new AssetArchive();
+    }
+    return instance;
+}
+
+bool AssetArchive::Map(const std::string &path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE fileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!fileMapping) {
+        CloseHandle(file);
+        return false;
+    }
+
+    void *view = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(fileMapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = fileMapping;
+    mapping = (const Uint8 *)view;
+    mappingSize = (size_t)size.QuadPart;
+#else
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(file, &info) != 0 || info.st_size == 0) {
+        close(file);
+        return false;
+    }
+
+    void *view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    // The mapping stays valid without the descriptor
+    close(file);
+    if (view == MAP_FAILED)
+        return false;
+
+    mapping = (const Uint8 *)view;
+    mappingSize = (size_t)info.st_size;
+#endif
+    return true;
+}
+
+void AssetArchive::Unmap() {
+    entries.clear();
+    path.clear();
+    if (!mapping)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(mapping);
+    CloseHandle((HANDLE)mappingHandle);
+    CloseHandle((HANDLE)fileHandle);
+    mappingHandle = fileHandle = nullptr;
+#else
+    munmap((void *)mapping, mappingSize);
+#endif
+    mapping = nullptr;
+    mappingSize = 0;
+}
+
+static Uint32 ReadUint32(const Uint8 *data) {
+    Uint32 value;
+    memcpy(&value, data, sizeof(value));
+    return SDL_SwapLE32(value);
+}
+
+static Uint16 ReadUint16(const Uint8 *data) {
+    Uint16 value;
+    memcpy(&value, data, sizeof(value));
+    return SDL_SwapLE16(value);
+}
+
+bool AssetArchive::ReadIndex() {
+    if (mappingSize < sizeof(ArchiveHeader) || memcmp(mapping, ARCHIVE_MAGIC, 4) != 0)
+        return false;
+
+    Uint32 version = ReadUint32(mapping + offsetof(ArchiveHeader, version));
+    Uint32 entryCount = ReadUint32(mapping + offsetof(ArchiveHeader, entryCount));
+    Uint32 indexSize = ReadUint32(mapping + offsetof(ArchiveHeader, indexSize));
+    if (version != ARCHIVE_VERSION || indexSize > mappingSize - sizeof(ArchiveHeader))
+        return false;
+
+    const Uint8 *cursor = mapping + sizeof(ArchiveHeader);
+    const Uint8 *indexEnd = cursor + indexSize;
+    for (Uint32 i = 0; i < entryCount; i++) {
+        if (indexEnd - cursor < 12)
+            return false;
+        Uint32 offset = ReadUint32(cursor);
+        Uint32 size = ReadUint32(cursor + 4);
+        Uint8 type = cursor[8];
+        Uint16 nameLength = ReadUint16(cursor + 10);
+        cursor += 12;
+
+        if (indexEnd - cursor < nameLength || offset > mappingSize || size > mappingSize - offset)
+            return false;
+
+        std::string name((const char *)cursor, nameLength);
+        cursor += nameLength;
+
+        entries[NormalizeName(name)] = {mapping + offset, size, (ArchiveEntryType)type};
+    }
+
+    return true;
+}
+
+bool AssetArchive::Open(const std::string &path) {
+    if (IsOpen())
+        return true;
+
+    PROFILE_ZONE_DETAIL("AssetArchive::Open", path.c_str());
+    if (!Map(path))
+        return false;
+
+    if (!ReadIndex()) {
+        std::cerr << "Invalid asset archive: " << path << std::endl;
+        Unmap();
+        return false;
+    }
+
+    this->path = path;
+    std::cout << "Asset archive opened: " << path << " (" << entries.size() << " files)" << std::endl;
+    return true;
+}
+
+bool AssetArchive::IsOpen() const {
+    return mapping != nullptr;
+}
+
+const std::string &AssetArchive::GetPath() const {
+    return path;
+}
+
+bool AssetArchive::Contains(const std::string &name) const {
+    return entries.find(NormalizeName(name)) != entries.end();
+}
+
+SDL_RWops *AssetArchive::OpenFile(const std::string &name) const {
+    auto entry = entries.find(NormalizeName(name));
+    if (entry == entries.end())
+        return nullptr;
+    return SDL_RWFromConstMem(entry->second.data, (int)entry->second.size);
+}
+
+int AssetArchive::GetEntryCount() const {
+    return (int)entries.size();
+}
+
+std::string AssetArchive::NormalizeName(const std::string &name) {
+    std::string normalized = name;
+    for (char &c : normalized) {
+        c = c == '\\' ? '/' : (char)tolower((unsigned char)c);
+    }
+    return normalized;
+}
+
+SDL_RWops *OpenAsset(const std::string &path) {
+    SDL_RWops *packed = AssetArchive::GetInstance()->OpenFile(path);
+    if (packed)
+        return packed;
+    return SDL_RWFromFile(path.c_str(), "rb");
+}
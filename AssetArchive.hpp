@@ -0,0 +1,86 @@
+#ifndef ASSETARCHIVE_HPP
+#define ASSETARCHIVE_HPP
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <unordered_map>
+
+/*Asset archive layout, written by the packer (Packer.cpp), all integers little-endian:
+    ArchiveHeader
+    entryCount index entries: Uint32 offset, Uint32 size, Uint8 type, Uint8 reserved, Uint16 nameLength, name
+    file data, every file starting on an ARCHIVE_ALIGNMENT boundary
+Names are the paths the game asks for, e.g. "Assets/Sprites/yard.png", with forward slashes.
+*/
+#define ARCHIVE_MAGIC "APAK"
+const Uint32 ARCHIVE_VERSION = 1;
+const Uint32 ARCHIVE_ALIGNMENT = 16;
+
+struct ArchiveHeader {
+    char magic[4];
+    Uint32 version;
+    Uint32 entryCount;
+    Uint32 indexSize; // Bytes of index entries following the header
+};
+
+enum ArchiveEntryType {
+    ARCHIVE_ENTRY_DATA,
+    ARCHIVE_ENTRY_IMAGE,
+    ARCHIVE_ENTRY_AUDIO,
+    ARCHIVE_ENTRY_FONT
+};
+
+/*Read-only view of the asset archive, memory-mapped once and kept for the whole run.
+Files are handed out as SDL_RWFromConstMem streams over the mapping, so decoders read them
+without another open call or a copy. Views stay valid only while it is open, keep it open until exit.
+Lookups ignore case, like the Windows file system the loose files are loaded from.
+*/
+class AssetArchive {
+private:
+    struct Entry {
+        const Uint8 *data;
+        Uint32 size;
+        ArchiveEntryType type;
+    };
+
+    std::unordered_map<std::string, Entry> entries;
+
+    const Uint8 *mapping = nullptr;
+    size_t mappingSize = 0;
+#ifdef _WIN32
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#endif
+
+    std::string path;
+
+    bool Map(const std::string &path);
+    void Unmap();
+    bool ReadIndex();
+
+    AssetArchive();
+    static AssetArchive *instance;
+
+public:
+    ~AssetArchive();
+    static AssetArchive *GetInstance();
+
+    // Maps the archive at path, returns false if there is none or it is invalid. Call before loading starts.
+    bool Open(const std::string &path);
+    bool IsOpen() const;
+    // Archive file the entries come from, empty while closed
+    const std::string &GetPath() const;
+
+    bool Contains(const std::string &name) const;
+    // Stream over the packed file, nullptr if the archive doesn't have it. Safe from any thread once open.
+    SDL_RWops *OpenFile(const std::string &name) const;
+
+    int GetEntryCount() const;
+
+    // Lookup key for a path, lower case with forward slashes
+    static std::string NormalizeName(const std::string &name);
+};
+
+// The asset at path from the archive if it has it, the loose file otherwise. nullptr if neither exists.
+SDL_RWops *OpenAsset(const std::string &path);
+
+#endif // ASSETARCHIVE_HPP
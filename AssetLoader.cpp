@@ -0,0 +1,159 @@
+#include "AssetLoader.hpp"
+#include "AudioCache.hpp"
+#include "CustomClasses.hpp"
+#include "Profiler.hpp"
+
+#include <iostream>
+
+AssetLoader *AssetLoader::instance = nullptr;
+
+AssetLoader::AssetLoader() {
+    mutex = SDL_CreateMutex();
+    pool = new ThreadPool("AssetLoader");
+}
+
+AssetLoader::~AssetLoader() {
+    // Stops the workers first, nothing writes to loaded after this
+    delete pool;
+
+    for (auto &asset : loaded) {
+        Release(asset);
+    }
+    loaded.clear();
+
+    SDL_DestroyMutex(mutex);
+
+    instance = nullptr;
+}
+
+AssetLoader *AssetLoader::GetInstance() {
+    if (instance == nullptr) {
+        instance = new AssetLoader();
+    }
+    return instance;
+}
+
+void AssetLoader::Queue(LoadedAsset asset, std::function<void(LoadedAsset &)> decode) {
+    queuedCount++;
+
+    pool->Submit([this, asset, decode]() mutable {
+        decode(asset);
+
+        SDL_LockMutex(mutex);
+        loaded.push_back(asset);
+        SDL_UnlockMutex(mutex);
+    });
+}
+
+void AssetLoader::Release(LoadedAsset &asset) {
+    if (asset.surface)
+        SDL_FreeSurface(asset.surface);
+    if (asset.sound)
+        Mix_FreeChunk(asset.sound);
+}
+
+void AssetLoader::QueueTexture(const std::string &path) {
+    if (!queuedTextures.insert(path).second)
+        return;
+
+    LoadedAsset asset;
+    asset.type = ASSET_TEXTURE;
+    asset.key = path;
+    Queue(asset, [path](LoadedAsset &asset) {
+        PROFILE_ZONE_DETAIL("DecodeImage", path.c_str());
+        asset.surface = LoadSpriteSurface(path);
+    });
+}
+
+void AssetLoader::QueueScaledTexture(const std::string &path, int width, int height, const SDL_Rect *region) {
+    std::string key = GetScaledSpriteSheetKey(path, width, height, region);
+    if (!queuedTextures.insert(key).second)
+        return;
+
+    LoadedAsset asset;
+    asset.type = ASSET_TEXTURE;
+    asset.key = key;
+    SDL_Rect area = region ? *region : SDL_Rect{0, 0, 0, 0};
+    bool hasRegion = region != nullptr;
+    Queue(asset, [path, width, height, area, hasRegion](LoadedAsset &asset) {
+        asset.surface = LoadScaledSurface(path, width, height, hasRegion ? &area : nullptr);
+    });
+}
+
+void AssetLoader::QueueSound(const std::string &name, const std::string &path, int volume, int priority) {
+    LoadedAsset asset;
+    asset.type = ASSET_SOUND;
+    asset.key = name;
+    asset.volume = volume;
+    asset.priority = priority;
+    Queue(asset, [path](LoadedAsset &asset) {
+        asset.sound = AudioCache::GetInstance()->Load(path);
+    });
+}
+
+void AssetLoader::QueueMusic(const std::string &name, const std::string &path, int volume) {
+    LoadedAsset asset;
+    asset.type = ASSET_MUSIC;
+    asset.key = name;
+    asset.volume = volume;
+    Queue(asset, [path](LoadedAsset &asset) {
+        asset.sound = AudioCache::GetInstance()->Load(path);
+    });
+}
+
+void AssetLoader::Update(double budgetMs) {
+    if (finishedCount == queuedCount)
+        return;
+
+    PROFILE_ZONE("AssetLoader::Update");
+    Uint64 start = SDL_GetPerformanceCounter();
+    Uint64 budget = (Uint64)(budgetMs * SDL_GetPerformanceFrequency() / 1000.0);
+
+    do {
+        SDL_LockMutex(mutex);
+        if (loaded.empty()) {
+            SDL_UnlockMutex(mutex);
+            break;
+        }
+        LoadedAsset asset = loaded.front();
+        loaded.pop_front();
+        SDL_UnlockMutex(mutex);
+
+        switch (asset.type) {
+        case ASSET_TEXTURE:
+            if (asset.surface) {
+                PROFILE_ZONE_DETAIL("UploadTexture", asset.key.c_str());
+                AddSpriteSheet(asset.key, asset.surface);
+                SDL_FreeSurface(asset.surface);
+            }
+            break;
+        case ASSET_SOUND:
+            if (asset.sound)
+                SoundManager::GetInstance()->AddSound(asset.key, asset.sound, asset.volume, asset.priority);
+            break;
+        case ASSET_MUSIC:
+            if (asset.sound)
+                SoundManager::GetInstance()->AddMusic(asset.key, asset.sound, asset.volume);
+            break;
+        }
+
+        finishedCount++;
+    } while (SDL_GetPerformanceCounter() - start < budget);
+}
+
+void AssetLoader::Finish() {
+    pool->Wait();
+    while (finishedCount < queuedCount) {
+        Update(1000);
+    }
+}
+
+bool AssetLoader::IsDone() {
+    return finishedCount == queuedCount;
+}
+
+float AssetLoader::GetProgress() {
+    if (queuedCount == 0)
+        return 1;
+    return (float)finishedCount / queuedCount;
+}
@@ -0,0 +1,72 @@
+#ifndef ASSETLOADER_HPP
+#define ASSETLOADER_HPP
+
+#include "ThreadPool.hpp"
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+#include <deque>
+#include <set>
+#include <string>
+
+/*Loads images and audio in the background so the window keeps responding.
+Worker threads decode the files, Update hands the results over on the main thread:
+images are uploaded to textures within a time budget per frame and land in the sprite sheet cache,
+sounds and music are decoded through the AudioCache and registered with the SoundManager. Scenes keep using LoadSpriteSheet and
+the SoundManager as before and find everything already loaded.
+The SoundManager has to be created (it opens the audio device) before audio is queued.
+*/
+class AssetLoader {
+private:
+    enum AssetType {
+        ASSET_TEXTURE,
+        ASSET_SOUND,
+        ASSET_MUSIC
+    };
+
+    // A decoded asset waiting for the main thread, or a failed one with nothing set
+    struct LoadedAsset {
+        AssetType type;
+        std::string key; // Sprite sheet cache key or SoundManager name
+        int volume = 128;
+        int priority = 0;
+        SDL_Surface *surface = nullptr;
+        Mix_Chunk *sound = nullptr; // Sound or music, both are decoded up front
+    };
+
+    ThreadPool *pool = nullptr;
+
+    SDL_mutex *mutex = nullptr;
+    std::deque<LoadedAsset> loaded;
+
+    std::set<std::string> queuedTextures;
+    int queuedCount = 0;
+    int finishedCount = 0;
+
+    void Queue(LoadedAsset asset, std::function<void(LoadedAsset &)> decode);
+    // Frees an asset that was never handed over
+    static void Release(LoadedAsset &asset);
+
+    AssetLoader();
+    static AssetLoader *instance;
+
+public:
+    ~AssetLoader();
+    static AssetLoader *GetInstance();
+
+    void QueueTexture(const std::string &path);
+    // Same result as LoadSpriteSheetScaled with these arguments
+    void QueueScaledTexture(const std::string &path, int width, int height, const SDL_Rect *region = nullptr);
+    void QueueSound(const std::string &name, const std::string &path, int volume, int priority = 0);
+    void QueueMusic(const std::string &name, const std::string &path, int volume);
+
+    // Hands finished assets over until budgetMs is used up, at least one per call. Main thread only.
+    void Update(double budgetMs);
+    // Blocks until everything queued is loaded and handed over, for runs that can't wait a few frames
+    void Finish();
+
+    bool IsDone();
+    // Share of the queued assets handed over, 1 when nothing is queued
+    float GetProgress();
+};
+
+#endif // ASSETLOADER_HPP
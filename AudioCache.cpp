@@ -0,0 +1,143 @@
+#include "AudioCache.hpp"
+#include "AssetArchive.hpp"
+#include "CustomClasses.hpp"
+#include "Global.hpp"
+#include "Profiler.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+AudioCache *AudioCache::instance = nullptr;
+
+AudioCache::AudioCache() {
+    mutex = SDL_CreateMutex();
+}
+
+AudioCache::~AudioCache() {
+    clips.clear();
+    SDL_DestroyMutex(mutex);
+
+    instance = nullptr;
+}
+
+AudioCache *AudioCache::GetInstance() {
+    if (instance == nullptr) {
+        instance = new AudioCache();
+    }
+    return instance;
+}
+
+bool AudioCache::ReadCacheFile(const std::string &cachePath, const std::string &path, int frequency, Uint16 format, int channels, std::vector<Uint8> &samples) {
+    time_t sourceTime, cacheTime;
+    if (!GetModifiedTime(cachePath, cacheTime) || !GetAssetModifiedTime(path, sourceTime) || cacheTime < sourceTime)
+        return false;
+
+    SDL_RWops *rw = SDL_RWFromFile(cachePath.c_str(), "rb");
+    if (!rw)
+        return false;
+    PROFILE_ZONE_DETAIL("ReadAudioCache", path.c_str());
+
+    AudioCacheHeader header;
+    bool valid = SDL_RWread(rw, header.magic, 4, 1) == 1 && memcmp(header.magic, AUDIO_CACHE_MAGIC, 4) == 0;
+    if (valid) {
+        header.version = SDL_ReadLE32(rw);
+        header.frequency = SDL_ReadLE32(rw);
+        header.format = SDL_ReadLE32(rw);
+        header.channels = SDL_ReadLE32(rw);
+        header.dataSize = SDL_ReadLE32(rw);
+        // Written for another device format, decode again
+        valid = header.version == AUDIO_CACHE_VERSION && header.frequency == (Uint32)frequency &&
+                header.format == format && header.channels == (Uint32)channels;
+    }
+    if (valid) {
+        // A damaged header mustn't allocate more than the file holds
+        Sint64 available = SDL_RWsize(rw) - SDL_RWtell(rw);
+        valid = available >= 0 && header.dataSize <= (Uint64)available;
+    }
+
+    if (valid) {
+        samples.resize(header.dataSize);
+        valid = SDL_RWread(rw, samples.data(), 1, samples.size()) == samples.size();
+    }
+    SDL_RWclose(rw);
+
+    if (!valid)
+        samples.clear();
+    return valid;
+}
+
+void AudioCache::WriteCacheFile(const std::string &cachePath, int frequency, Uint16 format, int channels, const std::vector<Uint8> &samples) {
+    SDL_RWops *rw = SDL_RWFromFile(cachePath.c_str(), "wb");
+    if (!rw) {
+        std::cerr << "Failed to create audio cache: " << cachePath << ": " << SDL_GetError() << std::endl;
+        return;
+    }
+
+    bool written = SDL_RWwrite(rw, AUDIO_CACHE_MAGIC, 4, 1) == 1 &&
+                   SDL_WriteLE32(rw, AUDIO_CACHE_VERSION) && SDL_WriteLE32(rw, frequency) &&
+                   SDL_WriteLE32(rw, format) && SDL_WriteLE32(rw, channels) &&
+                   SDL_WriteLE32(rw, (Uint32)samples.size()) &&
+                   SDL_RWwrite(rw, samples.data(), 1, samples.size()) == samples.size();
+    SDL_RWclose(rw);
+
+    // A partial file would pass the timestamp check next run
+    if (!written) {
+        std::cerr << "Failed to write audio cache: " << cachePath << std::endl;
+        remove(cachePath.c_str());
+    }
+}
+
+Mix_Chunk *AudioCache::Load(const std::string &path) {
+    int frequency, channels;
+    Uint16 format;
+    if (Mix_QuerySpec(&frequency, &format, &channels) == 0) {
+        std::cerr << "Failed to load sound: " << path << ": audio device not open" << std::endl;
+        return nullptr;
+    }
+
+    std::string key = AssetArchive::NormalizeName(path);
+
+    SDL_LockMutex(mutex);
+    auto cached = clips.find(key);
+    if (cached != clips.end()) {
+        std::vector<Uint8> &samples = cached->second;
+        SDL_UnlockMutex(mutex);
+        return Mix_QuickLoad_RAW(samples.data(), (Uint32)samples.size());
+    }
+    SDL_UnlockMutex(mutex);
+
+    std::string cachePath = GetAssetCachePath(path, AUDIO_CACHE_EXTENSION);
+    std::vector<Uint8> samples;
+    if (!AUDIO_DISK_CACHE || !ReadCacheFile(cachePath, path, frequency, format, channels, samples)) {
+        // Decodes the whole file and converts it to the device format, the expensive part for compressed audio
+        PROFILE_ZONE_DETAIL("DecodeAudio", path.c_str());
+        Mix_Chunk *decoded = Mix_LoadWAV_RW(OpenAsset(path), 1);
+        if (!decoded) {
+            std::cerr << "Failed to load sound: " << path << " SDL_mixer Error: " << Mix_GetError() << std::endl;
+            return nullptr;
+        }
+        samples.assign(decoded->abuf, decoded->abuf + decoded->alen);
+        Mix_FreeChunk(decoded);
+
+        if (AUDIO_DISK_CACHE)
+            WriteCacheFile(cachePath, frequency, format, channels, samples);
+    }
+
+    // Another thread may have loaded the same file meanwhile, the first copy stays
+    SDL_LockMutex(mutex);
+    std::vector<Uint8> &stored = clips.insert({key, std::move(samples)}).first->second;
+    SDL_UnlockMutex(mutex);
+
+    return Mix_QuickLoad_RAW(stored.data(), (Uint32)stored.size());
+}
+
+size_t AudioCache::GetMemoryUsage() {
+    SDL_LockMutex(mutex);
+    size_t total = 0;
+    for (auto &pair : clips) {
+        total += pair.second.size();
+    }
+    SDL_UnlockMutex(mutex);
+    return total;
+}
@@ -0,0 +1,56 @@
+#ifndef AUDIOCACHE_HPP
+#define AUDIOCACHE_HPP
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+#include <map>
+#include <string>
+#include <vector>
+
+/*Audio clips decoded once to the PCM format the device was opened with, so SDL_mixer never converts
+or decodes while playing and a scene reload doesn't decode again.
+Samples stay in memory for the whole run, chunks handed out only point at them (Mix_FreeChunk leaves
+the samples alone). With AUDIO_DISK_CACHE the decoded samples are also written to ASSET_CACHE_DIR as .pcm
+files, later runs read those back instead of decoding while they are newer than the source and match the device.
+Costs 176 KB per second of 44.1 kHz stereo audio, music included.
+*/
+#define AUDIO_CACHE_MAGIC "RPCM"
+#define AUDIO_CACHE_EXTENSION ".pcm"
+const Uint32 AUDIO_CACHE_VERSION = 1;
+
+struct AudioCacheHeader {
+    char magic[4];
+    Uint32 version;
+    Uint32 frequency;
+    Uint32 format; // SDL_AudioFormat
+    Uint32 channels;
+    Uint32 dataSize;
+};
+
+class AudioCache {
+private:
+    SDL_mutex *mutex = nullptr;
+    // Decoded samples by normalized path, never changed once added so chunks can point into them
+    std::map<std::string, std::vector<Uint8>> clips;
+
+    // Fills samples from the .pcm file of path if it is valid for this device
+    bool ReadCacheFile(const std::string &cachePath, const std::string &path, int frequency, Uint16 format, int channels, std::vector<Uint8> &samples);
+    void WriteCacheFile(const std::string &cachePath, int frequency, Uint16 format, int channels, const std::vector<Uint8> &samples);
+
+    AudioCache();
+    static AudioCache *instance;
+
+public:
+    // Chunks from Load must be freed before this
+    ~AudioCache();
+    // Create on the main thread after the audio device is opened, the SoundManager does
+    static AudioCache *GetInstance();
+
+    // Chunk over the decoded samples of path, nullptr if it can't be loaded. Safe from worker threads.
+    Mix_Chunk *Load(const std::string &path);
+
+    // Bytes of decoded samples held
+    size_t GetMemoryUsage();
+};
+
+#endif // AUDIOCACHE_HPP
@@ -0,0 +1,192 @@
+#include "BallPredictor.hpp"
+#include "Physic2D.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Stands in for "forever" when there is no drag
+static const float NEVER = 1e9f;
+
+static const int INTERCEPT_STEPS = 16;
+
+BallPredictor::BallPredictor() {}
+
+void BallPredictor::SetBody(float drag, float bounciness) {
+    this->drag = drag;
+    this->bounciness = bounciness;
+}
+
+void BallPredictor::SetBounds(Vector2 min, Vector2 max) {
+    boundsMin = min;
+    boundsMax = max;
+}
+
+void BallPredictor::SetGoal(int index, const GoalMouth &mouth) {
+    if (index >= 0 && index < GOAL_COUNT)
+        goals[index] = mouth;
+}
+
+float BallPredictor::GetMovingTicks(float speed) const {
+    if (speed <= 0)
+        return 0;
+    if (drag <= 0)
+        return NEVER;
+
+    // Tick t moves while speed * r^t is at least the minimum
+    float r = 1 - drag;
+    if (speed * r < Rigidbody2D::MINIMUM_VELOCITY)
+        return 0;
+    return std::floor(std::log(Rigidbody2D::MINIMUM_VELOCITY / speed) / std::log(r));
+}
+
+float BallPredictor::GetDistance(float speed, float ticks) const {
+    if (drag <= 0)
+        return speed * ticks;
+
+    float r = 1 - drag;
+    return speed * r * (1 - std::pow(r, ticks)) / (1 - r);
+}
+
+float BallPredictor::GetTicksTo(float speed, float distance) const {
+    if (distance <= 0)
+        return 0;
+    if (distance > GetDistance(speed, GetMovingTicks(speed)))
+        return -1;
+    if (drag <= 0)
+        return distance / speed;
+
+    // GetDistance solved for ticks
+    float r = 1 - drag;
+    float remaining = 1 - distance * (1 - r) / (speed * r);
+    if (remaining <= 0)
+        return -1;
+    return std::log(remaining) / std::log(r);
+}
+
+Vector2 BallPredictor::Trace(Vector2 position, Vector2 velocity, float untilTicks, BallPrediction *prediction) const {
+    BallPrediction unused;
+    BallPrediction &result = prediction ? *prediction : unused;
+    result = BallPrediction();
+
+    float elapsed = 0;
+    float speed = velocity.Magnitude();
+    Vector2 direction = speed > 0 ? velocity / speed : Vector2(0, 0);
+
+    while (speed > 0) {
+        float movingTicks = GetMovingTicks(speed);
+        if (movingTicks <= 0)
+            break;
+        float length = GetDistance(speed, movingTicks);
+
+        // Nearest bound ahead, a ball already past one bounces right away
+        float endDistance = length;
+        int wallAxis = -1;
+        if (direction.x != 0) {
+            float bound = direction.x < 0 ? boundsMin.x : boundsMax.x;
+            float distance = std::max(0.0f, (bound - position.x) / direction.x);
+            if (distance < endDistance) {
+                endDistance = distance;
+                wallAxis = 0;
+            }
+        }
+        if (direction.y != 0) {
+            float bound = direction.y < 0 ? boundsMin.y : boundsMax.y;
+            float distance = std::max(0.0f, (bound - position.y) / direction.y);
+            if (distance < endDistance) {
+                endDistance = distance;
+                wallAxis = 1;
+            }
+        }
+
+        // Goal mouths before it
+        int goal = -1;
+        for (int i = 0; i < GOAL_COUNT; i++) {
+            if (direction.x * goals[i].direction <= 0)
+                continue;
+            float distance = (goals[i].x - position.x) / direction.x;
+            float y = position.y + direction.y * distance;
+            if (distance >= 0 && distance <= endDistance && y >= goals[i].yMin && y <= goals[i].yMax) {
+                endDistance = distance;
+                goal = i;
+            }
+        }
+
+        float endTicks = endDistance < length ? GetTicksTo(speed, endDistance) : movingTicks;
+        if (endTicks < 0)
+            endTicks = movingTicks;
+
+        if (untilTicks >= 0 && elapsed + endTicks >= untilTicks)
+            return position + direction * GetDistance(speed, untilTicks - elapsed);
+
+        position += direction * endDistance;
+        elapsed += endTicks;
+
+        if (goal >= 0) {
+            result.goal = goal;
+            result.goalPosition = position;
+            result.goalTime = elapsed;
+            break;
+        }
+
+        if (wallAxis < 0 || endDistance >= length)
+            break;
+
+        // StayInBounds reflects the velocity and scales it by the bounciness
+        speed *= std::pow(1 - drag, endTicks) * bounciness;
+        if (wallAxis == 0)
+            direction.x = -direction.x;
+        else
+            direction.y = -direction.y;
+
+        if (++result.bounces >= MAX_BOUNCES)
+            break;
+    }
+
+    result.stopPosition = position;
+    result.stopTime = elapsed;
+    return position;
+}
+
+BallPrediction BallPredictor::Predict(Vector2 position, Vector2 velocity) const {
+    BallPrediction prediction;
+    Trace(position, velocity, -1, &prediction);
+    return prediction;
+}
+
+Vector2 BallPredictor::GetPositionAt(Vector2 position, Vector2 velocity, float ticks) const {
+    return Trace(position, velocity, std::max(0.0f, ticks), nullptr);
+}
+
+Vector2 BallPredictor::Intercept(Vector2 position, Vector2 velocity, Vector2 from, float speed, float *ticks) const {
+    BallPrediction prediction = Predict(position, velocity);
+
+    // Positive while the ball is still out of reach after t ticks
+    auto gap = [&](float t) {
+        return (GetPositionAt(position, velocity, t) - from).Magnitude() - speed * t;
+    };
+
+    float time = 0;
+    Vector2 point = position;
+    if (gap(0) > 0) {
+        float high = prediction.stopTime;
+        if (speed <= 0 || gap(high) > 0) {
+            point = prediction.stopPosition;
+            time = speed > 0 ? std::max(high, (point - from).Magnitude() / speed) : high;
+        } else {
+            float low = 0;
+            for (int step = 0; step < INTERCEPT_STEPS; step++) {
+                float middle = (low + high) / 2;
+                if (gap(middle) > 0)
+                    low = middle;
+                else
+                    high = middle;
+            }
+            time = high;
+            point = GetPositionAt(position, velocity, time);
+        }
+    }
+
+    if (ticks)
+        *ticks = time;
+    return point;
+}
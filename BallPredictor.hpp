@@ -0,0 +1,67 @@
+#ifndef BALLPREDICTOR_HPP
+#define BALLPREDICTOR_HPP
+
+#include "CustomClasses.hpp"
+
+// Vertical line the ball scores through, crossed moving in direction
+struct GoalMouth {
+    float x = 0;
+    float yMin = 0, yMax = 0;
+    float direction = 0; // -1 scores moving left, 1 moving right, 0 for no goal
+};
+
+struct BallPrediction {
+    Vector2 stopPosition = Vector2(0, 0);
+    float stopTime = 0; // Ticks until the ball rests
+    int bounces = 0;
+
+    // First goal mouth the ball passes through, -1 if none. The path ends there.
+    int goal = -1;
+    Vector2 goalPosition = Vector2(0, 0);
+    float goalTime = 0;
+};
+
+/*Ball path in closed form, without stepping the simulation.
+Rigidbody2D multiplies the velocity by r = 1 - drag every tick and moves by it, so after t ticks a ball
+at speed s has covered s * r * (1 - r^t) / (1 - r), and it rests once s * r^t drops under MINIMUM_VELOCITY.
+A straight leg is solved with a log, the path only breaks where StayInBounds bounces it off the bounds
+(velocity reflected and scaled by bounciness). Queries cost O(bounces), at most MAX_BOUNCES.
+Players, kicks and bindings aren't foreseen. Times are fractional ticks, the ball itself moves in whole ones.
+*/
+class BallPredictor {
+public:
+    static const int MAX_BOUNCES = 8;
+    static const int GOAL_COUNT = 2;
+
+private:
+    float drag = 0;
+    float bounciness = 1;
+    Vector2 boundsMin = Vector2(0, 0), boundsMax = Vector2(0, 0);
+    GoalMouth goals[GOAL_COUNT];
+
+    // Ticks a leg starting at speed keeps moving, and the distance covered after ticks of it
+    float GetMovingTicks(float speed) const;
+    float GetDistance(float speed, float ticks) const;
+    // Ticks until distance is covered, -1 if the leg stops short of it
+    float GetTicksTo(float speed, float distance) const;
+
+    // Follows the path, stopping early at untilTicks if it is >= 0. Returns the position at the end.
+    Vector2 Trace(Vector2 position, Vector2 velocity, float untilTicks, BallPrediction *prediction) const;
+
+public:
+    BallPredictor();
+
+    void SetBody(float drag, float bounciness);
+    void SetBounds(Vector2 min, Vector2 max);
+    void SetGoal(int index, const GoalMouth &mouth);
+
+    BallPrediction Predict(Vector2 position, Vector2 velocity) const;
+    Vector2 GetPositionAt(Vector2 position, Vector2 velocity, float ticks) const;
+
+    /*Where a player at from, running speed per tick, can meet the ball, and after how many ticks.
+    The resting point if the ball can't be reached before it stops. Bisects the path in a fixed number of steps.
+    */
+    Vector2 Intercept(Vector2 position, Vector2 velocity, Vector2 from, float speed, float *ticks = nullptr) const;
+};
+
+#endif // BALLPREDICTOR_HPP
@@ -0,0 +1,249 @@
+// Micro-benchmarks for the engine's hot primitives.
+// Build with `make bench`, run `bench [filter]`. Results go to bench_results.csv and bench_results.json.
+// Allocations are counted by the AllocationTracker hooks, the bench target always builds with TRACK_ALLOCATIONS.
+#include "CustomClasses.hpp"
+#include "Global.hpp"
+#include "Physic2D.hpp"
+#include "Profiler.hpp"
+#include <SDL2/SDL.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#pragma region Harness
+
+struct BenchResult {
+    std::string name;
+    int n = 1;
+    Uint64 iterations = 0;
+    double nsPerOp = 0;
+    double allocationsPerOp = 0;
+};
+
+static std::vector<BenchResult> results;
+static std::string filter;
+
+// Keeps the optimiser from dropping benchmarked expressions
+static volatile float sink = 0;
+
+const double MIN_BENCH_SECONDS = 0.2;
+
+// Runs body in growing batches until MIN_BENCH_SECONDS is reached, one call of body is one op
+template <typename F>
+void Bench(const std::string &name, int n, F body) {
+    std::string fullName = n > 1 ? name + "/" + std::to_string(n) : name;
+    if (!filter.empty() && fullName.find(filter) == std::string::npos)
+        return;
+
+    // Warm up caches and lazily created state
+    body();
+
+    double frequency = (double)SDL_GetPerformanceFrequency();
+    Uint64 batch = 1, iterations = 0, allocations = 0;
+    double elapsed = 0;
+
+    while (elapsed < MIN_BENCH_SECONDS) {
+        Uint64 allocationsBefore = AllocationTracker::GetTotalAllocations();
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (Uint64 i = 0; i < batch; i++) {
+            body();
+        }
+        Uint64 end = SDL_GetPerformanceCounter();
+
+        allocations += AllocationTracker::GetTotalAllocations() - allocationsBefore;
+        elapsed += (end - start) / frequency;
+        iterations += batch;
+        batch *= 2;
+    }
+
+    BenchResult result;
+    result.name = name;
+    result.n = n;
+    result.iterations = iterations;
+    result.nsPerOp = elapsed * 1e9 / iterations;
+    result.allocationsPerOp = (double)allocations / iterations;
+    results.push_back(result);
+
+    printf("%-40s %12.1f ns/op %10.2f allocs/op %12llu iterations\n",
+           fullName.c_str(), result.nsPerOp, result.allocationsPerOp, (unsigned long long)iterations);
+}
+
+static void WriteResults() {
+    std::ofstream csv("bench_results.csv");
+    csv << "name,n,iterations,ns_per_op,allocs_per_op\n";
+    for (auto &result : results) {
+        csv << result.name << "," << result.n << "," << result.iterations << ","
+            << result.nsPerOp << "," << result.allocationsPerOp << "\n";
+    }
+
+    std::ofstream json("bench_results.json");
+    json << "[\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        BenchResult &result = results[i];
+        json << "  {\"name\": \"" << result.name << "\", \"n\": " << result.n
+             << ", \"iterations\": " << result.iterations
+             << ", \"ns_per_op\": " << result.nsPerOp
+             << ", \"allocs_per_op\": " << result.allocationsPerOp << "}"
+             << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    json << "]\n";
+
+    std::cout << "Results written to bench_results.csv and bench_results.json" << std::endl;
+}
+
+// Objects spread over the pitch, like the ones the game spawns
+static std::mt19937 rng(1234);
+
+static Vector2 RandomPosition() {
+    std::uniform_real_distribution<float> x(0, WIDTH), y(0, HEIGHT);
+    return Vector2(x(rng), y(rng));
+}
+
+#pragma endregion
+
+#pragma region Benchmarks
+
+static void BenchVector2() {
+    Vector2 a(3.0f, 4.0f), b(-1.5f, 2.0f);
+
+    Bench("Vector2::operator+", 1, [&]() { sink = (a + b).x; });
+    Bench("Vector2::operator*", 1, [&]() { sink = (a * 1.5f).y; });
+    Bench("Vector2::Magnitude", 1, [&]() { sink = a.Magnitude(); });
+    Bench("Vector2::Normalize", 1, [&]() { sink = a.Normalize().x; });
+    Bench("Vector2::Distance", 1, [&]() { sink = Vector2::Distance(a, b); });
+    Bench("Vector2::Dot", 1, [&]() { sink = Vector2::Dot(a, b); });
+    Bench("Vector2::SignedAngle", 1, [&]() { sink = Vector2::SignedAngle(a, b); });
+}
+
+static void BenchNarrowphase() {
+    GameObject circleObject("Circle"), otherCircleObject("OtherCircle"), boxObject("Box"), otherBoxObject("OtherBox");
+    circleObject.transform.position = Vector2(100, 100);
+    otherCircleObject.transform.position = Vector2(120, 100);
+    boxObject.transform.position = Vector2(110, 110);
+    otherBoxObject.transform.position = Vector2(130, 110);
+
+    Collider2D *circle = (Collider2D *)circleObject.AddComponent(new CircleCollider2D(&circleObject, Vector2(0, 0), 17));
+    Collider2D *otherCircle = (Collider2D *)otherCircleObject.AddComponent(new CircleCollider2D(&otherCircleObject, Vector2(0, 0), 17));
+    Collider2D *box = (Collider2D *)boxObject.AddComponent(new BoxCollider2D(&boxObject, Vector2(0, 0), Vector2(32, 32)));
+    Collider2D *otherBox = (Collider2D *)otherBoxObject.AddComponent(new BoxCollider2D(&otherBoxObject, Vector2(0, 0), Vector2(32, 32)));
+
+    // Through the virtual entry point, the way CollisionManager calls them
+    Bench("CircleCollider2D::CheckCollision(circle)", 1, [&]() { sink = circle->CheckCollision(otherCircle); });
+    Bench("CircleCollider2D::CheckCollision(box)", 1, [&]() { sink = circle->CheckCollision(box); });
+    Bench("BoxCollider2D::CheckCollision(circle)", 1, [&]() { sink = box->CheckCollision(circle); });
+    Bench("BoxCollider2D::CheckCollision(box)", 1, [&]() { sink = box->CheckCollision(otherBox); });
+    Bench("CircleCollider2D::CheckCollision(point)", 1, [&]() { sink = circle->CheckCollision(Vector2(105, 95)); });
+
+    CollisionManager::GetInstance()->Clear();
+}
+
+static void BenchGetComponent() {
+    GameObject player("Player");
+    player.AddComponent(new SpriteRenderer(&player, Vector2(32, 32)));
+    player.AddComponent(new Rigidbody2D(&player, 1, 0.04, .2));
+    player.AddComponent(new CircleCollider2D(&player, Vector2(0, 0), 34));
+
+    Bench("GameObject::GetComponent(first)", 1, [&]() { sink = player.GetComponent<SpriteRenderer>() != nullptr; });
+    Bench("GameObject::GetComponent(last)", 1, [&]() { sink = player.GetComponent<CircleCollider2D>() != nullptr; });
+    Bench("GameObject::GetComponent(base)", 1, [&]() { sink = player.GetComponent<Collider2D>() != nullptr; });
+    Bench("GameObject::GetComponent(missing)", 1, [&]() { sink = player.GetComponent<Animator>() != nullptr; });
+
+    CollisionManager::GetInstance()->Clear();
+}
+
+static void BenchCollisionManager() {
+    for (int n : {10, 100, 1000, 10000}) {
+        std::vector<GameObject *> objects;
+        for (int i = 0; i < n; i++) {
+            GameObject *object = new GameObject("Collider" + std::to_string(i));
+            object->transform.position = RandomPosition();
+            if (i % 4 == 0)
+                object->AddComponent(new BoxCollider2D(object, Vector2(0, 0), Vector2(32, 32)));
+            else
+                object->AddComponent(new CircleCollider2D(object, Vector2(0, 0), 17));
+            objects.push_back(object);
+        }
+
+        Bench("CollisionManager::Update", n, []() { CollisionManager::GetInstance()->Update(); });
+
+        CollisionManager::GetInstance()->Clear();
+        for (auto &object : objects) {
+            delete object;
+        }
+    }
+}
+
+static void BenchDraw(SDL_Texture *texture) {
+    for (int n : {10, 100, 1000, 10000}) {
+        for (int i = 0; i < n; i++) {
+            GameObject *object = new GameObject("Sprite" + std::to_string(i));
+            object->transform.position = RandomPosition();
+            object->AddComponent(new SpriteRenderer(object, Vector2(4, 4), i % 3, texture));
+            GameObjectManager::GetInstance()->AddGameObject(object);
+        }
+
+        Bench("GameObjectManager::Draw", n, []() { GameObjectManager::GetInstance()->Draw(); });
+
+        GameObjectManager::GetInstance()->Clear();
+    }
+}
+
+static void BenchEvent() {
+    Event<Collider2D *> event;
+    int calls = 0;
+    event.addHandler([&calls](Collider2D *) { calls++; });
+
+    Bench("Event::raise(1 handler)", 1, [&]() { event.raise(nullptr); });
+
+    for (int i = 0; i < 3; i++) {
+        event.addHandler([&calls](Collider2D *) { calls++; });
+    }
+    Bench("Event::raise(4 handlers)", 1, [&]() { event.raise(nullptr); });
+
+    Event<> noArgs;
+    noArgs.addHandler([&calls]() { calls++; });
+    Bench("Event<>::raise", 1, [&]() { noArgs.raise(); });
+
+    sink = (float)calls;
+}
+
+#pragma endregion
+
+int main(int argc, char *argv[]) {
+    if (argc > 1)
+        filter = argv[1];
+
+    if (SDL_Init(SDL_INIT_TIMER) != 0) {
+        std::cerr << "Failed to initialise SDL: " << SDL_GetError() << std::endl;
+        return 1;
+    }
+
+    // Software renderer on an offscreen surface, so drawing needs no window
+    SDL_Surface *target = SDL_CreateRGBSurfaceWithFormat(0, WIDTH, HEIGHT, 32, SDL_PIXELFORMAT_RGBA32);
+    RENDERER = SDL_CreateSoftwareRenderer(target);
+    if (!RENDERER) {
+        std::cerr << "Failed to create software renderer: " << SDL_GetError() << std::endl;
+        return 1;
+    }
+    SDL_Texture *texture = SDL_CreateTexture(RENDERER, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, 4, 4);
+
+    BenchVector2();
+    BenchNarrowphase();
+    BenchGetComponent();
+    BenchCollisionManager();
+    BenchDraw(texture);
+    BenchEvent();
+
+    WriteResults();
+
+    SDL_DestroyTexture(texture);
+    SDL_DestroyRenderer(RENDERER);
+    SDL_FreeSurface(target);
+    SDL_Quit();
+
+    return 0;
+}
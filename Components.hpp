@@ -1,12 +1,21 @@
 #ifndef COMPONENTS_HPP
 #define COMPONENTS_HPP
 
+#include "AIParams.hpp"
+#include "AIScheduler.hpp"
+#include "BallPredictor.hpp"
 #include "CustomClasses.hpp"
 #include "Game.hpp"
 #include "Helper.hpp"
+#include "InfluenceMap.hpp"
 #include "Physic2D.hpp"
+#include "ThreadPool.hpp"
 #include "cmath"
 
+#include <algorithm>
+#include <fstream>
+#include <random>
+
 class BallStateMachine : public Component {
 private:
     float maxSpeed = 0;
@@ -23,6 +32,9 @@ private:
     float bindCooldown = 0;
     float lastBindTime = 0;
 
+    SoundId bounceSound = INVALID_SOUND;
+    SoundId kickSound = INVALID_SOUND;
+
 public:
     enum State {
         FREE,
@@ -37,6 +49,9 @@ public:
         this->bounceKickerCooldown = bounceKickerCooldown;
 
         this->rigidbody = this->gameObject->GetComponent<Rigidbody2D>();
+
+        bounceSound = SoundManager::GetInstance()->GetSoundId("ball_bounce");
+        kickSound = SoundManager::GetInstance()->GetSoundId("ball_kick");
     }
 
     void OnCollisionEnter(Collider2D *other) {
@@ -50,7 +65,7 @@ public:
         } else if (currentState == KICKED) {
             // If collided with the last kicker
             // Check if the cooldown has passed
-            if (other->gameObject == lastKickedBy && SDL_GetTicks() - lastKickedTime > bounceKickerCooldown) {
+            if (other->gameObject == lastKickedBy && Game::GetTime() - lastKickedTime > bounceKickerCooldown) {
                 Bind(other->gameObject);
             }
 
@@ -61,7 +76,7 @@ public:
 
             // Bounce off anything else
             else {
-                SoundManager::GetInstance()->PlaySound("ball_bounce");
+                SoundManager::GetInstance()->PlaySound(bounceSound, gameObject->transform.position);
                 rigidbody->BounceOff(other->GetNormal(gameObject->transform.position));
             }
         }
@@ -94,14 +109,14 @@ public:
 
     void Kick(Vector2 direction, float force, GameObject *kicker) {
         if (currentState == BINDED) {
-            SoundManager::GetInstance()->PlaySound("ball_kick");
+            SoundManager::GetInstance()->PlaySound(kickSound, gameObject->transform.position);
             currentState = KICKED;
             rigidbody->AddForce(direction * force);
             lastKickedBy = kicker;
-            lastKickedTime = SDL_GetTicks();
+            lastKickedTime = Game::GetTime();
 
             // Set bindcooldown;
-            lastBindTime = SDL_GetTicks();
+            lastBindTime = Game::GetTime();
 
             // Set backup rigidbody
             gameObject->GetComponent<VelocityToAnimSpeedController>()->SetBackupRigidbody(nullptr);
@@ -109,10 +124,10 @@ public:
     }
 
     void Bind(GameObject *binder, bool ignoreCooldown = false) {
-        if (SDL_GetTicks() - lastBindTime < bindCooldown && !ignoreCooldown)
+        if (Game::GetTime() - lastBindTime < bindCooldown && !ignoreCooldown)
             return;
 
-        lastBindTime = SDL_GetTicks();
+        lastBindTime = Game::GetTime();
         currentState = BINDED;
         lastBindedBy = binder;
 
@@ -145,27 +160,30 @@ class MovementController : public Component {
 
 private:
     Rigidbody2D *rigidbody;
-    SDL_Keycode upKey, downKey, leftKey, rightKey;
+    int player;
+    std::vector<int> subscriptions;
 
     float upSpeed = 0, downSpeed = 0, leftSpeed = 0, rightSpeed = 0;
 
 public:
     float speed = 0;
 
-    MovementController(GameObject *parent, float speed, bool useWASD) : Component(parent) {
+    // player is the input player, 0 for team 1 and 1 for team 2
+    MovementController(GameObject *parent, float speed, int player) : Component(parent) {
         this->speed = speed;
+        this->player = player;
         this->rigidbody = this->gameObject->GetComponent<Rigidbody2D>();
 
-        if (useWASD) {
-            upKey = SDLK_w;
-            downKey = SDLK_s;
-            leftKey = SDLK_a;
-            rightKey = SDLK_d;
-        } else {
-            upKey = SDLK_UP;
-            downKey = SDLK_DOWN;
-            leftKey = SDLK_LEFT;
-            rightKey = SDLK_RIGHT;
+        InputManager *input = InputManager::GetInstance();
+        subscriptions.push_back(input->Subscribe(player, ACTION_MOVE_UP, [this](bool pressed) { upSpeed = pressed ? -1 : 0; }));
+        subscriptions.push_back(input->Subscribe(player, ACTION_MOVE_DOWN, [this](bool pressed) { downSpeed = pressed ? 1 : 0; }));
+        subscriptions.push_back(input->Subscribe(player, ACTION_MOVE_LEFT, [this](bool pressed) { leftSpeed = pressed ? -1 : 0; }));
+        subscriptions.push_back(input->Subscribe(player, ACTION_MOVE_RIGHT, [this](bool pressed) { rightSpeed = pressed ? 1 : 0; }));
+    }
+
+    ~MovementController() {
+        for (int id : subscriptions) {
+            InputManager::GetInstance()->Unsubscribe(id);
         }
     }
 
@@ -174,29 +192,21 @@ public:
             return;
         if (rigidbody == nullptr)
             return;
+        if (upSpeed + downSpeed == 0 && leftSpeed + rightSpeed == 0)
+            return;
 
         float actualSpeed = speed * 1 / FPS;
 
-        if (Game::event.type == SDL_KEYDOWN || Game::event.type == SDL_KEYUP) {
-            if (Game::event.key.keysym.sym == upKey) {
-                upSpeed = Game::event.type == SDL_KEYDOWN ? -1 : 0;
-            }
-            if (Game::event.key.keysym.sym == downKey) {
-                downSpeed = Game::event.type == SDL_KEYDOWN ? 1 : 0;
-            }
-            if (Game::event.key.keysym.sym == leftKey) {
-                leftSpeed = Game::event.type == SDL_KEYDOWN ? -1 : 0;
-            }
-            if (Game::event.key.keysym.sym == rightKey) {
-                rightSpeed = Game::event.type == SDL_KEYDOWN ? 1 : 0;
-            }
-        }
-
         rigidbody->AddForce(Vector2(leftSpeed + rightSpeed, upSpeed + downSpeed).Normalize() * actualSpeed);
     }
 
     void Enable() {
-        ClearSpeed();
+        // Pick up keys already held, so a player switched to mid-press moves right away
+        InputManager *input = InputManager::GetInstance();
+        upSpeed = input->GetAction(player, ACTION_MOVE_UP) ? -1 : 0;
+        downSpeed = input->GetAction(player, ACTION_MOVE_DOWN) ? 1 : 0;
+        leftSpeed = input->GetAction(player, ACTION_MOVE_LEFT) ? -1 : 0;
+        rightSpeed = input->GetAction(player, ACTION_MOVE_RIGHT) ? 1 : 0;
         enabled = true;
     }
     void Disable() {
@@ -217,7 +227,7 @@ public:
     void Draw() {}
 
     Component *Clone(GameObject *parent) {
-        MovementController *newMovementController = new MovementController(parent, speed, upKey == SDLK_w);
+        MovementController *newMovementController = new MovementController(parent, speed, player);
         return newMovementController;
     }
 };
@@ -226,27 +236,46 @@ private:
     SDL_Texture *indicator = nullptr;
     float indicatorRadius = 0;
 
+    int player;
+    std::vector<int> subscriptions;
+
+    // Keyed by switch action
     std::map<int, MovementController *> movementControllers;
     int currentKey = -1;
 
+    void Switch(int action) {
+        if (action == currentKey || movementControllers.find(action) == movementControllers.end())
+            return;
+
+        movementControllers[currentKey]->Disable();
+
+        movementControllers[action]->Enable();
+        currentKey = action;
+    }
+
 public:
-    TeamControl(GameObject *parent, SDL_Texture *indicator, float indicatorRadius) : Component(parent) {
+    TeamControl(GameObject *parent, SDL_Texture *indicator, float indicatorRadius, int player) : Component(parent) {
         this->indicator = indicator;
         this->indicatorRadius = indicatorRadius;
+        this->player = player;
+
+        InputManager *input = InputManager::GetInstance();
+        for (InputAction action : {ACTION_SWITCH_PLAYER_1, ACTION_SWITCH_PLAYER_2, ACTION_SWITCH_PLAYER_3}) {
+            subscriptions.push_back(input->Subscribe(player, action, [this, action](bool pressed) {
+                if (pressed)
+                    Switch(action);
+            }));
+        }
     }
 
-    void Update() {
-        if (Game::event.type == SDL_KEYDOWN) {
-            SDL_Keycode key = Game::event.key.keysym.sym;
-            if (movementControllers.find(key) != movementControllers.end()) {
-                movementControllers[currentKey]->Disable();
-
-                movementControllers[key]->Enable();
-                currentKey = key;
-            }
+    ~TeamControl() {
+        for (int id : subscriptions) {
+            InputManager::GetInstance()->Unsubscribe(id);
         }
     }
 
+    void Update() {}
+
     void Draw() {
         if (currentKey != -1) {
             MovementController *currentController = movementControllers[currentKey];
@@ -260,11 +289,13 @@ public:
                     static_cast<int>(indicatorRadius),
                     static_cast<int>(indicatorRadius)};
                 SDL_RenderCopy(RENDERER, indicator, nullptr, &rect);
+                Counters::Increment(COUNTER_DRAW_CALLS);
             }
         }
     }
 
-    void AddMovementController(int keyBind, MovementController *movementController) {
+    void AddMovementController(InputAction switchAction, MovementController *movementController) {
+        int keyBind = switchAction;
         movementControllers[keyBind] = movementController;
 
         // Enable only the first movement controller when adding
@@ -276,7 +307,8 @@ public:
         }
     }
 
-    void RemoveMovementController(int keyBind) {
+    void RemoveMovementController(InputAction switchAction) {
+        int keyBind = switchAction;
         movementControllers[keyBind] = nullptr;
 
         // Enable the first controller when removing
@@ -286,9 +318,9 @@ public:
     }
 
     Component *Clone(GameObject *parent) {
-        TeamControl *newMovementControllerSwitcher = new TeamControl(parent, indicator, indicatorRadius);
+        TeamControl *newMovementControllerSwitcher = new TeamControl(parent, indicator, indicatorRadius, player);
         for (auto &movementController : movementControllers) {
-            newMovementControllerSwitcher->AddMovementController(movementController.first, movementController.second);
+            newMovementControllerSwitcher->AddMovementController((InputAction)movementController.first, movementController.second);
         }
         return newMovementControllerSwitcher;
     }
@@ -297,7 +329,8 @@ public:
 class KickControl : public Component {
 private:
     Rigidbody2D *rigidbody = nullptr;
-    SDL_KeyCode kickKey = SDLK_SPACE;
+    int player;
+    int subscription = 0;
 
     GameObject *ball = nullptr;
     BallStateMachine *ballStateMachine = nullptr;
@@ -307,17 +340,28 @@ private:
     Vector2 lastDirection = Vector2(0, 0);
 
 public:
-    KickControl(GameObject *parent, GameObject *ball, SDL_KeyCode kickKey, float kickForce) : Component(parent) {
+    KickControl(GameObject *parent, GameObject *ball, int player, float kickForce) : Component(parent) {
         this->rigidbody = this->gameObject->GetComponent<Rigidbody2D>();
         this->ball = ball;
-        this->kickKey = kickKey;
+        this->player = player;
 
         this->kickForce = kickForce;
 
         ballStateMachine = ball->GetComponent<BallStateMachine>();
+
+        subscription = InputManager::GetInstance()->Subscribe(player, ACTION_KICK, [this](bool pressed) {
+            if (pressed)
+                Kick();
+        });
     }
 
-    void Update() {
+    ~KickControl() {
+        InputManager::GetInstance()->Unsubscribe(subscription);
+    }
+
+    void Update() {}
+
+    void Kick() {
         if (!rigidbody || !ballStateMachine) {
             rigidbody = gameObject->GetComponent<Rigidbody2D>();
             ballStateMachine = ball->GetComponent<BallStateMachine>();
@@ -331,35 +375,285 @@ public:
             return;
         }
 
-        if (Game::event.type == SDL_KEYDOWN && Game::event.key.keysym.sym == kickKey) {
-            if (ballStateMachine->GetBinded() != gameObject) {
-                return;
-            }
-            if (rigidbody->velocity.Magnitude() > 0.01f) {
-                lastDirection = rigidbody->velocity.Normalize();
-            }
-            ballStateMachine->Kick(lastDirection, kickForce, gameObject);
+        if (ballStateMachine->GetBinded() != gameObject) {
+            return;
+        }
+        if (rigidbody->velocity.Magnitude() > 0.01f) {
+            lastDirection = rigidbody->velocity.Normalize();
         }
+        ballStateMachine->Kick(lastDirection, kickForce, gameObject);
     }
 
     void Draw() {}
 
     Component *Clone(GameObject *parent) {
-        KickControl *newShootControl = new KickControl(parent, ball, kickKey, kickForce);
+        KickControl *newShootControl = new KickControl(parent, ball, player, kickForce);
         return newShootControl;
     }
 };
 
 // AI Control
-// Auto take over the control of the object if movement controller is not enabled
+
+// A registered player as it was when the blackboard was refreshed
+struct AIPlayerState {
+    GameObject *player = nullptr;
+    int tag = 0;
+    Vector2 position = Vector2(0, 0);
+};
+
+/*What the AI controllers know about the ball and the teams, gathered once per tick by the first controller
+that asks instead of by every controller on its own. Covers every registered player, AI driven or not.
+Controllers register their player and ball when created and leave when destroyed.
+The ball's path is predicted once per tick too, goal mouths are indexed by the team defending them (tag - 1).
+It is also the snapshot the decide jobs read on the "AI" pool. It only changes in Sync, after the previous
+tick's jobs are done, so nothing a job reads from it moves underneath it.
+*/
+class AIBlackboard {
+public:
+    static const int TEAM_COUNT = 2;
+
+    GameObject *ball = nullptr;
+    BallStateMachine *ballState = nullptr;
+    Vector2 ballPosition = Vector2(0, 0), ballVelocity = Vector2(0, 0);
+
+    // Player the ball is bound to and its tag, nullptr and 0 while the ball is free
+    GameObject *binder = nullptr;
+    int possessingTeam = 0;
+
+    // Closest player of each team to the ball, indexed by tag - 1
+    GameObject *nearestPlayer[TEAM_COUNT] = {nullptr, nullptr};
+    float nearestDistance[TEAM_COUNT] = {0, 0};
+
+    // Where the free ball rests or scores, the ball itself while it is bound
+    BallPrediction prediction;
+
+    // Who covers which part of the pitch, teams indexed by tag - 1
+    InfluenceMap influence;
+
+    // How often each controller decides
+    AIScheduler scheduler;
+
+private:
+    BallPredictor predictor;
+    std::vector<GameObject *> players;
+    // Influence source of each player, same order as players
+    std::vector<int> playerSources;
+    int ballSource = -1;
+    std::vector<AIPlayerState> playerStates;
+
+    // Runs the controllers' decide jobs
+    ThreadPool *pool = nullptr;
+    Rigidbody2D *ballRigidbody = nullptr;
+
+    // GameObjectManager update the values were gathered in
+    Uint64 refreshedAt = 0;
+
+    void Refresh() {
+        PROFILE_ZONE("AIBlackboard::Refresh");
+        if (ballState == nullptr)
+            ballState = ball->GetComponent<BallStateMachine>();
+        if (ballRigidbody == nullptr) {
+            ballRigidbody = ball->GetComponent<Rigidbody2D>();
+            if (ballRigidbody)
+                predictor.SetBody(ballRigidbody->GetDrag(), ballRigidbody->GetBounciness());
+        }
+
+        ballPosition = ball->transform.position;
+        ballVelocity = ballRigidbody ? ballRigidbody->velocity : Vector2(0, 0);
+        binder = ballState ? ballState->GetBinded() : nullptr;
+        possessingTeam = binder ? binder->tag : 0;
+
+        prediction = predictor.Predict(ballPosition, binder ? Vector2(0, 0) : ballVelocity);
+
+        for (int team = 0; team < TEAM_COUNT; team++) {
+            nearestPlayer[team] = nullptr;
+            nearestDistance[team] = 0;
+        }
+        // Only sources that changed cell get restamped
+        playerStates.resize(players.size());
+        for (size_t i = 0; i < players.size(); i++) {
+            playerStates[i].player = players[i];
+            playerStates[i].tag = players[i]->tag;
+            playerStates[i].position = players[i]->transform.position;
+            influence.MoveSource(playerSources[i], playerStates[i].position, playerStates[i].tag - 1);
+        }
+        influence.MoveSource(ballSource, ballPosition, possessingTeam - 1);
+
+        for (AIPlayerState &state : playerStates) {
+            int team = state.tag - 1;
+            if (team < 0 || team >= TEAM_COUNT)
+                continue;
+            float distance = (state.position - ballPosition).Magnitude();
+            if (nearestPlayer[team] == nullptr || distance < nearestDistance[team]) {
+                nearestPlayer[team] = state.player;
+                nearestDistance[team] = distance;
+            }
+        }
+    }
+
+    AIBlackboard() : influence(WIDTH, HEIGHT, INFLUENCE_CELL_SIZE, INFLUENCE_RADIUS) {
+        // The ball counts for whoever has it
+        ballSource = influence.AddSource(-1, 2);
+
+        pool = new ThreadPool("AI", Game::aiThreadCount);
+
+        // StayInBounds keeps the ball on screen
+        predictor.SetBounds(Vector2(0, 0), Vector2(WIDTH, HEIGHT));
+    }
+    static AIBlackboard *instance;
+
+public:
+    ~AIBlackboard() {
+        delete pool;
+        instance = nullptr;
+    }
+
+    static AIBlackboard *GetInstance() {
+        if (instance == nullptr) {
+            instance = new AIBlackboard();
+        }
+        return instance;
+    }
+
+    // Deletes the blackboard if there is one, unlike deleting GetInstance() it doesn't create one first
+    static void DestroyInstance() {
+        delete instance;
+    }
+
+    void AddPlayer(GameObject *player, GameObject *ball) {
+        if (this->ball != ball) {
+            this->ball = ball;
+            ballState = nullptr;
+            ballRigidbody = nullptr;
+            refreshedAt = 0;
+        }
+        players.push_back(player);
+        playerSources.push_back(influence.AddSource(player->tag - 1, 1));
+    }
+
+    void RemovePlayer(GameObject *player) {
+        for (size_t i = 0; i < players.size(); i++) {
+            if (players[i] != player)
+                continue;
+            influence.RemoveSource(playerSources[i]);
+            players.erase(players.begin() + i);
+            playerSources.erase(playerSources.begin() + i);
+            break;
+        }
+        if (players.empty())
+            ball = nullptr;
+    }
+
+    const std::vector<AIPlayerState> &GetPlayerStates() const {
+        return playerStates;
+    }
+
+    // Where the player was at the last refresh
+    Vector2 GetPosition(GameObject *player) const {
+        for (const AIPlayerState &state : playerStates) {
+            if (state.player == player)
+                return state.position;
+        }
+        return player->transform.position;
+    }
+
+    /*Brings the values up to date, only the first call of a tick does any work.
+    Waits for the previous tick's decide jobs first, their results are ready once it returns.
+    */
+    void Sync() {
+        Uint64 updateCount = GameObjectManager::GetInstance()->GetUpdateCount();
+        if (ball == nullptr || refreshedAt == updateCount)
+            return;
+        pool->Wait();
+        refreshedAt = updateCount;
+        Refresh();
+    }
+
+    // Queues a decide job, it may only read the blackboard
+    void SubmitDecision(std::function<void()> decide) {
+        pool->Submit(decide);
+    }
+
+    void WaitForDecisions() {
+        pool->Wait();
+    }
+
+    bool TeamHasBall(int tag) const {
+        return possessingTeam != 0 && possessingTeam == tag;
+    }
+
+    // Goal the team with this tag defends, the ball scores moving in direction through the side facing the field
+    void SetGoal(int tag, GameObject *goal, float direction) {
+        BoxCollider2D *collider = goal->GetComponent<BoxCollider2D>();
+        if (collider == nullptr)
+            return;
+
+        Vector2 min, max;
+        collider->GetBounds(min, max);
+        GoalMouth mouth;
+        mouth.x = direction < 0 ? max.x : min.x;
+        mouth.yMin = min.y;
+        mouth.yMax = max.y;
+        mouth.direction = direction;
+        predictor.SetGoal(tag - 1, mouth);
+    }
+
+    // Where a player at from running speed per tick meets the ball, see BallPredictor::Intercept
+    Vector2 Intercept(Vector2 from, float speed) const {
+        if (binder)
+            return ballPosition;
+        return predictor.Intercept(ballPosition, ballVelocity, from, speed);
+    }
+};
+
+AIBlackboard *AIBlackboard::instance = nullptr;
+
+// What a controller decided on a worker, applied on the main thread the next tick
+struct AIDecision {
+    Vector2 force = Vector2(0, 0);
+
+    bool kick = false;
+    Vector2 kickDirection = Vector2(0, 0);
+    float kickForce = 0;
+
+    void AddForce(Vector2 force) {
+        this->force += force;
+    }
+
+    void Kick(Vector2 direction, float force) {
+        kick = true;
+        kickDirection = direction;
+        kickForce = force;
+    }
+};
+
+/*Auto take over the control of the object if movement controller is not enabled.
+Decide runs on the blackboard's pool against the snapshot Sync took, and may only read the blackboard and
+the controller's own settings. Update applies the last decision on the main thread and queues the next one,
+so the AI acts on the world as it was a tick ago.
+*/
 class AIController : public Component {
 protected:
     Rigidbody2D *rigidbody;
     MovementController *movementController;
 
     GameObject *target;
+    AIBlackboard *blackboard;
 
+    AIParams params;
+    // Running speed of the role, from params
     float speed = 0;
+    // Top speed of the player at speed, taken on the main thread for the decide job
+    float terminalSpeed = 0;
+
+    // Written by the decide job, only read after Sync has waited for it
+    AIDecision decision;
+    bool decisionPending = false;
+    // Force of the last decision, applied every tick until the next one
+    Vector2 steering = Vector2(0, 0);
+
+    AIRole role = AI_ROLE_ATTACKER;
+    int slot = 0;
 
     float alertZoneXStart = 0, alertZoneXEnd = 0;
     float dangerZoneXStart = 0, dangerZoneXEnd = 0;
@@ -367,16 +661,116 @@ protected:
     bool isTeam1 = false;
 
 public:
-    AIController(GameObject *parent, GameObject *target, float speed, bool isTeam1) : Component(parent) {
+    AIController(GameObject *parent, GameObject *target, const AIParams &params, bool isTeam1) : Component(parent) {
         this->rigidbody = this->gameObject->GetComponent<Rigidbody2D>();
         this->movementController = this->gameObject->GetComponent<MovementController>();
         this->target = target;
-        this->speed = speed;
+        this->params = params;
 
         this->isTeam1 = isTeam1;
+
+        blackboard = AIBlackboard::GetInstance();
+        blackboard->AddPlayer(gameObject, target);
+        slot = blackboard->scheduler.AddAgent();
     }
 
-    virtual void Update() = 0;
+    // Subclasses wait for the decide jobs as well, their part is gone by the time this runs
+    ~AIController() {
+        blackboard->WaitForDecisions();
+        blackboard->scheduler.RemoveAgent(slot);
+        blackboard->RemovePlayer(gameObject);
+    }
+
+    // Opponent influence at which a player on the ball looks for a pass, about one opponent within two cells
+    static const int PRESSURE_INFLUENCE = 10;
+    // Most opponent influence along a lane still worth passing through
+    static const int PASS_LANE_RISK = 6;
+
+    // Teammate further up the pitch with the least contested lane, nullptr if every lane is riskier than maxRisk
+    GameObject *FindPassTarget(int maxRisk) {
+        int team = gameObject->tag - 1;
+        float forward = isTeam1 ? 1 : -1;
+        Vector2 from = blackboard->GetPosition(gameObject);
+
+        GameObject *best = nullptr;
+        int bestRisk = 0;
+        for (const AIPlayerState &state : blackboard->GetPlayerStates()) {
+            if (state.player == gameObject || state.tag != gameObject->tag)
+                continue;
+            Vector2 to = state.position;
+            if ((to.x - from.x) * forward < blackboard->influence.GetCellSize())
+                continue;
+
+            // The ball is past whoever presses the passer right away, start the lane a cell out
+            Vector2 start = from + (to - from).Normalize() * blackboard->influence.GetCellSize();
+            int risk = blackboard->influence.GetLaneRisk(team, start, to);
+            if (risk <= maxRisk && (best == nullptr || risk < bestRisk)) {
+                best = state.player;
+                bestRisk = risk;
+            }
+        }
+        return best;
+    }
+
+    // Kicks the ball to a teammate with an open lane, false if there is none
+    bool TryPass(float force) {
+        GameObject *receiver = FindPassTarget(PASS_LANE_RISK);
+        if (receiver == nullptr)
+            return false;
+        Vector2 direction = (blackboard->GetPosition(receiver) - blackboard->GetPosition(gameObject)).Normalize();
+        decision.Kick(direction, force);
+        return true;
+    }
+
+    // Fills decision from the blackboard, runs on a worker
+    virtual void Decide() = 0;
+
+    void Apply() {
+        if (decisionPending) {
+            decisionPending = false;
+            steering = decision.kick ? Vector2(0, 0) : decision.force;
+
+            // The kick was decided on the last tick, drop it if the ball isn't bound to this player anymore
+            if (decision.kick && blackboard->ballState->GetBinded() == gameObject)
+                blackboard->ballState->Kick(decision.kickDirection, decision.kickForce, gameObject);
+        }
+        rigidbody->AddForce(steering);
+    }
+
+    // Ticks until the next decision, see AIScheduler
+    int GetUpdateInterval() {
+        int possession = blackboard->possessingTeam == 0 ? 0 : (blackboard->TeamHasBall(gameObject->tag) ? 1 : -1);
+        bool urgent = blackboard->binder == gameObject || blackboard->prediction.goal == gameObject->tag - 1;
+        float ballDistance = (gameObject->transform.position - blackboard->ballPosition).Magnitude();
+        return blackboard->scheduler.GetInterval(role, ballDistance, possession, urgent);
+    }
+
+    void Update() {
+        if (rigidbody == nullptr)
+            return;
+
+        blackboard->Sync();
+
+        if (movementController != nullptr && movementController->GetEnabled()) {
+            decisionPending = false;
+            steering = Vector2(0, 0);
+            return;
+        }
+
+        Apply();
+
+        Uint64 tick = GameObjectManager::GetInstance()->GetUpdateCount();
+        if (!blackboard->scheduler.IsDue(slot, GetUpdateInterval(), tick))
+            return;
+
+        terminalSpeed = rigidbody->GetTerminalSpeed(speed * 1 / FPS);
+        decision = AIDecision();
+        decisionPending = true;
+        Counters::Increment(COUNTER_AI_DECISIONS);
+        blackboard->SubmitDecision([this]() {
+            Decide();
+        });
+    }
 
     void Draw() {}
 
@@ -388,20 +782,23 @@ private:
     float dangerZoneYStart = 0, dangerZoneYEnd = 0;
 
 public:
-    AIGoalKeeper(GameObject *parent, GameObject *target, float speed, bool isTeam1) : AIController(parent, target, speed, isTeam1) {
+    AIGoalKeeper(GameObject *parent, GameObject *target, const AIParams &params, bool isTeam1) : AIController(parent, target, params, isTeam1) {
+        role = AI_ROLE_GOALKEEPER;
+        speed = params.goalKeeperSpeed;
+
         if (isTeam1) {
             dangerZoneXStart = 0;
-            dangerZoneXEnd = 20.0f / 100.0f * WIDTH;
+            dangerZoneXEnd = params.keeperDangerDepth * WIDTH;
 
-            alertZoneXStart = 20.0f / 100.0f * WIDTH;
-            alertZoneXEnd = 60.0f / 100.0f * WIDTH;
+            alertZoneXStart = params.keeperDangerDepth * WIDTH;
+            alertZoneXEnd = params.keeperAlertDepth * WIDTH;
 
         } else {
-            dangerZoneXStart = 80.0f / 100.0f * WIDTH;
+            dangerZoneXStart = (1 - params.keeperDangerDepth) * WIDTH;
             dangerZoneXEnd = 100.0f / 100.0f * WIDTH;
 
-            alertZoneXStart = 40.0f / 100.0f * WIDTH;
-            alertZoneXEnd = 80.0f / 100.0f * WIDTH;
+            alertZoneXStart = (1 - params.keeperAlertDepth) * WIDTH;
+            alertZoneXEnd = (1 - params.keeperDangerDepth) * WIDTH;
         }
 
         dangerZoneYStart = 0.0f / 100.0f * HEIGHT;
@@ -410,135 +807,145 @@ public:
         this->rigidbody = this->gameObject->GetComponent<Rigidbody2D>();
     }
 
-    void Update() {
-        if (rigidbody == nullptr)
-            return;
-        if (movementController != nullptr && movementController->GetEnabled())
-            return;
+    ~AIGoalKeeper() {
+        blackboard->WaitForDecisions();
+    }
 
+    void Decide() {
         float actualSpeed = speed * 1 / FPS;
 
-        Vector2 targetPosition = target->transform.position;
-        Rigidbody2D *targetRigidbody = target->GetComponent<Rigidbody2D>();
+        Vector2 targetPosition = blackboard->ballPosition;
+        Vector2 currentPosition = blackboard->GetPosition(gameObject);
 
-        Vector2 currentPosition = gameObject->transform.position;
+        bool teamHasBall = blackboard->TeamHasBall(gameObject->tag);
+        bool shotOnGoal = blackboard->prediction.goal == gameObject->tag - 1;
 
-        GameObject *ballBindedBy = target->GetComponent<BallStateMachine>()->GetBinded();
-        bool teamHasBall = ballBindedBy != nullptr && ballBindedBy->tag == gameObject->tag;
+        // Where the keeper can get to the ball, rather than where the ball is now
+        Vector2 interceptPosition = blackboard->Intercept(currentPosition, terminalSpeed);
 
-        // Binded to ball
-        if (ballBindedBy != nullptr && ballBindedBy == gameObject) {
-            target->GetComponent<BallStateMachine>()->Kick(Vector2(isTeam1 ? 1 : -1, 0), HIGH_KICK_FORCE, gameObject);
+        // Binded to ball, play it out to an open teammate or clear it
+        if (blackboard->binder == gameObject) {
+            if (!TryPass(params.lowKickForce))
+                decision.Kick(Vector2(isTeam1 ? 1 : -1, 0), params.highKickForce);
         } else
+            // Ball heading into the goal, from wherever it is
+            if (shotOnGoal && !teamHasBall) {
+                Vector2 direction = (interceptPosition - currentPosition).Normalize();
+                decision.AddForce(Vector2(direction.x / 4, direction.y * 4).Normalize() * actualSpeed);
+            }
+
             // Target is in the alert zone
-            if (targetPosition.x >= alertZoneXStart && targetPosition.x <= alertZoneXEnd && !teamHasBall) {
+            else if (targetPosition.x >= alertZoneXStart && targetPosition.x <= alertZoneXEnd && !teamHasBall) {
 
-                if (targetPosition.y < currentPosition.y) {
-                    rigidbody->AddForce(Vector2(0, -1).Normalize() * actualSpeed);
-                } else if (targetPosition.y > currentPosition.y) {
-                    rigidbody->AddForce(Vector2(0, 1).Normalize() * actualSpeed);
+                if (interceptPosition.y < currentPosition.y) {
+                    decision.AddForce(Vector2(0, -1).Normalize() * actualSpeed);
+                } else if (interceptPosition.y > currentPosition.y) {
+                    decision.AddForce(Vector2(0, 1).Normalize() * actualSpeed);
                 }
             }
 
             // Target is in the danger zone
             else if (targetPosition.x >= dangerZoneXStart && targetPosition.x <= dangerZoneXEnd &&
                      targetPosition.y >= dangerZoneYStart && targetPosition.y <= dangerZoneYEnd && !teamHasBall) {
-                Vector2 direction = (targetPosition - currentPosition).Normalize();
+                Vector2 direction = (interceptPosition - currentPosition).Normalize();
                 // Prioritize running toward target position y
-                rigidbody->AddForce(Vector2(direction.x / 4, direction.y * 4).Normalize() * actualSpeed);
+                decision.AddForce(Vector2(direction.x / 4, direction.y * 4).Normalize() * actualSpeed);
             }
 
             // Target is neither, restore original position, or team has control of ball
             else {
                 Vector2 dangerZoneCenter((dangerZoneXStart + dangerZoneXEnd) / 2, (dangerZoneYStart + dangerZoneYEnd) / 2);
                 Vector2 direction = (dangerZoneCenter - currentPosition).Normalize();
-                rigidbody->AddForce(direction * actualSpeed);
+                decision.AddForce(direction * actualSpeed);
             }
     }
 
     Component *Clone(GameObject *parent) {
-        AIGoalKeeper *newAIGoalKeeper = new AIGoalKeeper(parent, target, speed, isTeam1);
+        AIGoalKeeper *newAIGoalKeeper = new AIGoalKeeper(parent, target, params, isTeam1);
         return newAIGoalKeeper;
     }
 };
 
 class AIDefender : public AIController {
 public:
-    AIDefender(GameObject *parent, GameObject *target, float speed, bool isTeam1) : AIController(parent, target, speed, isTeam1) {
+    AIDefender(GameObject *parent, GameObject *target, const AIParams &params, bool isTeam1) : AIController(parent, target, params, isTeam1) {
+        role = AI_ROLE_DEFENDER;
+        speed = params.defenderSpeed;
+
         if (isTeam1) {
             dangerZoneXStart = 0.0f / 100.0f * WIDTH;
-            dangerZoneXEnd = 50.0f / 100.0f * WIDTH;
+            dangerZoneXEnd = params.defenderDangerDepth * WIDTH;
 
-            alertZoneXStart = 50.0f / 100.0f * WIDTH;
-            alertZoneXEnd = 75.0f / 100.0f * WIDTH;
+            alertZoneXStart = params.defenderDangerDepth * WIDTH;
+            alertZoneXEnd = params.defenderAlertDepth * WIDTH;
         } else {
-            dangerZoneXStart = 50.0f / 100.0f * WIDTH;
+            dangerZoneXStart = (1 - params.defenderDangerDepth) * WIDTH;
             dangerZoneXEnd = 100.0f / 100.0f * WIDTH;
 
-            alertZoneXStart = 25.0f / 100.0f * WIDTH;
-            alertZoneXEnd = 50.0f / 100.0f * WIDTH;
+            alertZoneXStart = (1 - params.defenderAlertDepth) * WIDTH;
+            alertZoneXEnd = (1 - params.defenderDangerDepth) * WIDTH;
         }
 
         this->rigidbody = this->gameObject->GetComponent<Rigidbody2D>();
     }
 
-    void Update() {
-        if (rigidbody == nullptr)
-            return;
-        if (movementController != nullptr && movementController->GetEnabled())
-            return;
+    ~AIDefender() {
+        blackboard->WaitForDecisions();
+    }
 
+    void Decide() {
         float actualSpeed = speed * 1 / FPS;
 
-        Vector2 targetPosition = target->transform.position;
-        Vector2 currentPosition = gameObject->transform.position;
+        Vector2 targetPosition = blackboard->ballPosition;
+        Vector2 currentPosition = blackboard->GetPosition(gameObject);
 
-        GameObject *ballBindedBy = target->GetComponent<BallStateMachine>()->GetBinded();
-        bool teamHasBall = ballBindedBy != nullptr && ballBindedBy->tag == gameObject->tag;
-
-        // Binded to ball
-        if (ballBindedBy != nullptr && ballBindedBy == gameObject) {
-            target->GetComponent<BallStateMachine>()->Kick(Vector2(isTeam1 ? 1 : -1, 0), LOW_KICK_FORCE, gameObject);
+        // Binded to ball, pass up the pitch through an open lane or kick it forward
+        if (blackboard->binder == gameObject) {
+            if (!TryPass(params.lowKickForce))
+                decision.Kick(Vector2(isTeam1 ? 1 : -1, 0), params.lowKickForce);
         } else
 
-            // Target is in the alert zone
-            if (targetPosition.x >= alertZoneXStart && targetPosition.x <= alertZoneXEnd) {
-                Vector2 direction = (targetPosition - currentPosition).Normalize();
-                rigidbody->AddForce(direction * actualSpeed);
-            }
-
-            // Target is in the danger zone
-            else if (targetPosition.x >= dangerZoneXStart && targetPosition.x <= dangerZoneXEnd) {
-                Vector2 direction = (targetPosition - currentPosition).Normalize();
-                rigidbody->AddForce(direction * actualSpeed);
+            // Target is in the alert or danger zone, cut it off where it can be reached
+            if ((targetPosition.x >= alertZoneXStart && targetPosition.x <= alertZoneXEnd) ||
+                (targetPosition.x >= dangerZoneXStart && targetPosition.x <= dangerZoneXEnd)) {
+                Vector2 interceptPosition = blackboard->Intercept(currentPosition, terminalSpeed);
+                Vector2 direction = (interceptPosition - currentPosition).Normalize();
+                decision.AddForce(direction * actualSpeed);
             }
 
             // Target is neither, restore original position
             else {
                 Vector2 dangerZoneCenter((dangerZoneXStart + dangerZoneXEnd) / 2, WIDTH / 2);
                 Vector2 direction = (dangerZoneCenter - currentPosition).Normalize();
-                rigidbody->AddForce(direction * actualSpeed);
+                decision.AddForce(direction * actualSpeed);
             }
     }
 
     Component *Clone(GameObject *parent) {
-        AIDefender *newAIDefender = new AIDefender(parent, target, speed, isTeam1);
+        AIDefender *newAIDefender = new AIDefender(parent, target, params, isTeam1);
         return newAIDefender;
     }
 };
 
 class AIAttacker : public AIController {
+private:
+    // How far from its spot the attacker looks for space when the team has the ball
+    static constexpr float OPEN_SPACE_RADIUS = 160.0f;
+
 public:
-    AIAttacker(GameObject *parent, GameObject *target, float speed, bool isTeam1) : AIController(parent, target, speed, isTeam1) {
+    AIAttacker(GameObject *parent, GameObject *target, const AIParams &params, bool isTeam1) : AIController(parent, target, params, isTeam1) {
+        role = AI_ROLE_ATTACKER;
+        speed = params.attackerSpeed;
+
         if (isTeam1) {
-            dangerZoneXStart = 50.0f / 100.0f * WIDTH;
+            dangerZoneXStart = params.attackerDangerDepth * WIDTH;
             dangerZoneXEnd = 100.0f / 100.0f * WIDTH;
 
             alertZoneXStart = 100.0f / 100.0f * WIDTH;
             alertZoneXEnd = 100.0f / 100.0f * WIDTH;
         } else {
             dangerZoneXStart = 0.0f;
-            dangerZoneXEnd = 50.0f / 100.0f * WIDTH;
+            dangerZoneXEnd = (1 - params.attackerDangerDepth) * WIDTH;
 
             alertZoneXStart = 0.0f / 100.0f * WIDTH;
             alertZoneXEnd = 0.0f / 100.0f * WIDTH;
@@ -547,22 +954,18 @@ public:
         rigidbody = gameObject->GetComponent<Rigidbody2D>();
     }
 
-    void Update() {
-        if (rigidbody == nullptr)
-            return;
-        if (movementController != nullptr && movementController->GetEnabled())
-            return;
+    ~AIAttacker() {
+        blackboard->WaitForDecisions();
+    }
 
+    void Decide() {
         float actualSpeed = speed * 1 / FPS;
 
-        Vector2 targetPosition = target->transform.position;
-        Vector2 currentPosition = gameObject->transform.position;
-
-        GameObject *ballBindedBy = target->GetComponent<BallStateMachine>()->GetBinded();
-        bool teamHasBall = ballBindedBy != nullptr && ballBindedBy->tag == gameObject->tag;
+        Vector2 targetPosition = blackboard->ballPosition;
+        Vector2 currentPosition = blackboard->GetPosition(gameObject);
 
         // Binded to ball
-        if (ballBindedBy != nullptr && ballBindedBy == gameObject) {
+        if (blackboard->binder == gameObject) {
             Vector2 goalPosition = isTeam1 ? Vector2(95.0f / 100.0f * WIDTH, HEIGHT / 2) : Vector2(5.0f / 100.0f * WIDTH, HEIGHT / 2);
             Vector2 direction = (goalPosition - currentPosition).Normalize();
 
@@ -570,50 +973,67 @@ public:
             bool inOptimalYPosition = (20.0 / 100 * HEIGHT <= currentPosition.y && currentPosition.y <= 80.0 / 100 * HEIGHT);
 
             // Near goal conditions
-            bool nearGoalTeam1 = (isTeam1 && currentPosition.x >= 75.0f / 100.0f * WIDTH && currentPosition.x <= 85.0f / 100.0f * WIDTH);
-            bool nearGoalTeam2 = (!isTeam1 && currentPosition.x <= 25.0f / 100.0f * WIDTH && currentPosition.x >= 15.0f / 100.0f * WIDTH);
+            bool nearGoalTeam1 = (isTeam1 && currentPosition.x >= params.shootingRangeStart * WIDTH && currentPosition.x <= params.shootingRangeEnd * WIDTH);
+            bool nearGoalTeam2 = (!isTeam1 && currentPosition.x <= (1 - params.shootingRangeStart) * WIDTH && currentPosition.x >= (1 - params.shootingRangeEnd) * WIDTH);
 
             // Check if AI is behind the goal
             bool behindGoalTeam1 = (isTeam1 && currentPosition.x > 92.0f / 100.0f * WIDTH);
             bool behindGoalTeam2 = (!isTeam1 && currentPosition.x < 8.0f / 100.0f * WIDTH);
 
             if (inOptimalYPosition && (nearGoalTeam1 || nearGoalTeam2)) {
-                target->GetComponent<BallStateMachine>()->Kick(direction, HIGH_KICK_FORCE, gameObject);
+                decision.Kick(direction, params.highKickForce);
                 return;
             }
 
+            // Closed down, get rid of it if a teammate ahead is free
+            int opponentTeam = isTeam1 ? 1 : 0;
+            if (blackboard->influence.GetInfluence(opponentTeam, currentPosition) >= PRESSURE_INFLUENCE && TryPass(params.lowKickForce))
+                return;
+
             // If AI is behind the goal, move it toward the front of the goal
             if (behindGoalTeam1 || behindGoalTeam2) {
-                Vector2 frontOfGoal = isTeam1 ? Vector2(85.0f / 100.0f * WIDTH, HEIGHT / 2) : Vector2(15.0f / 100.0f * WIDTH, HEIGHT / 2);
+                Vector2 frontOfGoal = isTeam1 ? Vector2(params.shootingRangeEnd * WIDTH, HEIGHT / 2) : Vector2((1 - params.shootingRangeEnd) * WIDTH, HEIGHT / 2);
                 direction = (frontOfGoal - currentPosition).Normalize();
             }
 
             // Not near goal, run toward goal
-            rigidbody->AddForce(direction * actualSpeed);
+            decision.AddForce(direction * actualSpeed);
         } else
 
+            // A teammate has the ball, get free for a pass short of the goal line
+            if (blackboard->TeamHasBall(gameObject->tag)) {
+                float forward = isTeam1 ? 1 : -1;
+                float lastLine = isTeam1 ? params.shootingRangeEnd * WIDTH : (1 - params.shootingRangeEnd) * WIDTH;
+                Vector2 towards = (lastLine - currentPosition.x) * forward > 0 ? Vector2(forward, 0) : Vector2(-forward, 0);
+                Vector2 openPosition = blackboard->influence.FindOpenSpace(gameObject->tag - 1, currentPosition, OPEN_SPACE_RADIUS, towards);
+                if ((openPosition - currentPosition).Magnitude() > blackboard->influence.GetCellSize() / 2) {
+                    Vector2 direction = (openPosition - currentPosition).Normalize();
+                    decision.AddForce(direction * actualSpeed);
+                }
+            }
+
             // Target is in the alert zone
-            if (targetPosition.x >= alertZoneXStart && targetPosition.x <= alertZoneXEnd) {
+            else if (targetPosition.x >= alertZoneXStart && targetPosition.x <= alertZoneXEnd) {
                 Vector2 direction = (targetPosition - currentPosition).Normalize();
-                rigidbody->AddForce(direction * actualSpeed);
+                decision.AddForce(direction * actualSpeed);
             }
 
             // Target is in the danger zone
             else if (targetPosition.x >= dangerZoneXStart && targetPosition.x <= dangerZoneXEnd) {
                 Vector2 direction = (targetPosition - currentPosition).Normalize();
-                rigidbody->AddForce(direction * actualSpeed);
+                decision.AddForce(direction * actualSpeed);
             }
 
             // Target is neither, restore original position
             else {
                 Vector2 dangerZoneCenter((dangerZoneXStart + dangerZoneXEnd) / 2, currentPosition.y);
                 Vector2 direction = (dangerZoneCenter - currentPosition).Normalize();
-                rigidbody->AddForce(direction * actualSpeed);
+                decision.AddForce(direction * actualSpeed);
             }
     }
 
     Component *Clone(GameObject *parent) {
-        AIAttacker *newAIAttacker = new AIAttacker(parent, target, speed, isTeam1);
+        AIAttacker *newAIAttacker = new AIAttacker(parent, target, params, isTeam1);
         return newAIAttacker;
     }
 };
@@ -623,41 +1043,177 @@ private:
     Collider2D *collider = nullptr;
 
     Event<> *onClick = nullptr;
+    int subscription = 0;
 
 public:
     Button(GameObject *parent) : Component(parent) {
         onClick = new Event<>();
+
+        subscription = InputManager::GetInstance()->SubscribeClick([this](Vector2 position) {
+            if (collider == nullptr) {
+                collider = gameObject->GetComponent<Collider2D>();
+                if (collider == nullptr)
+                    return;
+            }
+
+            if (collider->CheckCollision(position)) {
+                this->onClick->raise();
+            }
+        });
     }
 
     ~Button() {
+        InputManager::GetInstance()->Unsubscribe(subscription);
         delete onClick;
     }
 
+    void Update() {}
+
+    void Draw() {}
+
+    void AddOnClickHandler(std::function<void()> handler) {
+        onClick->addHandler(handler);
+    }
+
+    Component *Clone(GameObject *parent) {
+        Button *newButton = new Button(parent);
+        newButton->onClick = onClick;
+        return newButton;
+    }
+};
+
+// Stress testing
+// Kicks the object in a random direction every interval updates, keeps the stress scene moving.
+// Times in updates and draws from its own seed so a stress run replays the same way.
+class RandomImpulse : public Component {
+private:
+    Rigidbody2D *rigidbody = nullptr;
+    float force = 0;
+    int interval = 0;
+    Uint64 nextImpulse = 0;
+
+    std::mt19937 rng;
+
+public:
+    RandomImpulse(GameObject *parent, float force, int interval) : Component(parent) {
+        this->force = force;
+        this->interval = interval > 0 ? interval : 1;
+        Seed(0, 0);
+    }
+
+    // Restarts the impulses from seed, objects sharing a seed pass different indices
+    void Seed(unsigned int seed, int index) {
+        std::seed_seq sequence{seed, (unsigned int)index};
+        rng.seed(sequence);
+
+        // Spread the impulses over the interval instead of firing them all on the same update
+        nextImpulse = GameObjectManager::GetInstance()->GetUpdateCount() + std::uniform_int_distribution<int>(1, interval)(rng);
+    }
+
     void Update() {
-        if (collider == nullptr) {
-            collider = gameObject->GetComponent<Collider2D>();
-            if (collider == nullptr)
+        if (rigidbody == nullptr) {
+            rigidbody = gameObject->GetComponent<Rigidbody2D>();
+            if (rigidbody == nullptr)
                 return;
         }
 
-        if (Game::event.type == SDL_MOUSEBUTTONDOWN) {
-            Vector2 mousePosition = Vector2(Game::event.button.x, Game::event.button.y);
-            if (collider->CheckCollision(mousePosition)) {
-                this->onClick->raise();
-            }
+        Uint64 updateCount = GameObjectManager::GetInstance()->GetUpdateCount();
+        if (updateCount < nextImpulse)
+            return;
+        nextImpulse = updateCount + interval;
+
+        std::uniform_real_distribution<float> angle(0, 2 * M_PI);
+        float a = angle(rng);
+        rigidbody->AddForce(Vector2(std::cos(a), std::sin(a)) * force);
+    }
+
+    void Draw() {}
+
+    Component *Clone(GameObject *parent) {
+        RandomImpulse *newRandomImpulse = new RandomImpulse(parent, force, interval);
+        return newRandomImpulse;
+    }
+};
+
+// Collects frame times, then logs percentiles against the entity count and appends them to a CSV file
+class StressMonitor : public Component {
+private:
+    int entityCount = 0;
+    int framesPerStep = 0;
+
+    // Frames right after the scene load carry the load itself
+    int warmupFrames = 10;
+
+    std::vector<float> frameTimes;
+
+    std::string csvPath;
+    bool writeHeader = false;
+
+    Event<> *onStepComplete = nullptr;
+
+    static float Percentile(const std::vector<float> &sorted, float percentile) {
+        if (sorted.empty())
+            return 0;
+        size_t index = (size_t)(percentile / 100.0f * (sorted.size() - 1) + 0.5f);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+public:
+    StressMonitor(GameObject *parent, int entityCount, int framesPerStep, std::string csvPath, bool writeHeader) : Component(parent) {
+        this->entityCount = entityCount;
+        this->framesPerStep = framesPerStep;
+        this->csvPath = csvPath;
+        this->writeHeader = writeHeader;
+        this->frameTimes.reserve(framesPerStep);
+
+        onStepComplete = new Event<>();
+    }
+
+    ~StressMonitor() {
+        delete onStepComplete;
+    }
+
+    void Update() {
+        if (warmupFrames > 0) {
+            warmupFrames--;
+            return;
         }
+        if ((int)frameTimes.size() >= framesPerStep)
+            return;
+
+        frameTimes.push_back(Game::frameTime);
+        if ((int)frameTimes.size() < framesPerStep)
+            return;
+
+        std::vector<float> sorted = frameTimes;
+        std::sort(sorted.begin(), sorted.end());
+        float p50 = Percentile(sorted, 50), p95 = Percentile(sorted, 95), p99 = Percentile(sorted, 99);
+        float max = sorted.back();
+
+        std::cout << "Stress: " << entityCount << " entities over " << sorted.size() << " frames, p50 " << p50
+                  << " ms, p95 " << p95 << " ms, p99 " << p99 << " ms, max " << max << " ms" << std::endl;
+
+        std::ofstream csv(csvPath, writeHeader ? std::ios::trunc : std::ios::app);
+        if (csv) {
+            if (writeHeader)
+                csv << "entities,frames,p50_ms,p95_ms,p99_ms,max_ms\n";
+            csv << entityCount << "," << sorted.size() << "," << p50 << "," << p95 << "," << p99 << "," << max << "\n";
+        } else {
+            std::cerr << "Failed to open stress results: " << csvPath << std::endl;
+        }
+
+        onStepComplete->raise();
     }
 
     void Draw() {}
 
-    void AddOnClickHandler(std::function<void()> handler) {
-        onClick->addHandler(handler);
+    void AddOnStepCompleteHandler(std::function<void()> handler) {
+        onStepComplete->addHandler(handler);
     }
 
     Component *Clone(GameObject *parent) {
-        Button *newButton = new Button(parent);
-        newButton->onClick = onClick;
-        return newButton;
+        StressMonitor *newStressMonitor = new StressMonitor(parent, entityCount, framesPerStep, csvPath, writeHeader);
+        return newStressMonitor;
     }
 };
 
@@ -1,10 +1,22 @@
 #include "CustomClasses.hpp"
+#include "AssetArchive.hpp"
+#include "AudioCache.hpp"
 #include "Global.hpp"
 #include "Physic2D.hpp"
+#include "Profiler.hpp"
+#include "TextureBlob.hpp"
+#include <cctype>
 #include <cmath>
 #include <iostream>
 #include <algorithm>
+#include <fstream>
 #include <list>
+#include <sstream>
+
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
 
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_mixer.h>
@@ -14,6 +26,8 @@
 GameObjectManager *GameObjectManager::instance = nullptr;
 SceneManager *SceneManager::instance = nullptr;
 SoundManager *SoundManager::instance = nullptr;
+InputManager *InputManager::instance = nullptr;
+RotatedSpriteCache *RotatedSpriteCache::instance = nullptr;
 
 SDL_Renderer *RENDERER = nullptr;
 std::vector<SDL_Texture *> TEXTURES;
@@ -156,16 +170,22 @@ void GameObjectManager::Clear() {
         delete pair.second;
     }
     gameObjects.clear();
+    redrawRequested = true;
 }
 
 void GameObjectManager::Update() {
+    PROFILE_ZONE("GameObjectManager::Update");
+    nextScheduledUpdate = 0;
+    updateCount++;
     for (auto &pair : gameObjects) {
         pair.second->Update();
     }
+    Counters::Increment(COUNTER_OBJECTS_UPDATED, (int)gameObjects.size());
 }
 
 //Draw ordered by SpriteRenderer drawOrder
 void GameObjectManager::Draw() {
+    PROFILE_ZONE("GameObjectManager::Draw");
 
     std::list<GameObject *> sortedGameObjects;
     for (auto &pair : gameObjects) {
@@ -176,23 +196,51 @@ void GameObjectManager::Draw() {
         sortedGameObjects.push_back(pair.second);
     }
 
-    sortedGameObjects.sort([](GameObject *a, GameObject *b) {
-        SpriteRenderer *aRenderer = a->GetComponent<SpriteRenderer>();
-        SpriteRenderer *bRenderer = b->GetComponent<SpriteRenderer>();
+    {
+        PROFILE_ZONE("Draw.Sort");
+        sortedGameObjects.sort([](GameObject *a, GameObject *b) {
+            SpriteRenderer *aRenderer = a->GetComponent<SpriteRenderer>();
+            SpriteRenderer *bRenderer = b->GetComponent<SpriteRenderer>();
 
-        int sortOrderA = aRenderer ? aRenderer->GetDrawOrder() : 0;
-        int sortOrderB = bRenderer ? bRenderer->GetDrawOrder() : 0;
+            int sortOrderA = aRenderer ? aRenderer->GetDrawOrder() : 0;
+            int sortOrderB = bRenderer ? bRenderer->GetDrawOrder() : 0;
 
-        if (sortOrderA == sortOrderB) {
-            return a->transform.position.y < b->transform.position.y;
-        }
+            if (sortOrderA == sortOrderB) {
+                return a->transform.position.y < b->transform.position.y;
+            }
         
-        return sortOrderA < sortOrderB;
-    });
+            return sortOrderA < sortOrderB;
+        });
+    }
 
+    PROFILE_ZONE("Draw.Submit");
     for (auto &gameObject : sortedGameObjects) {
         gameObject->Draw();
     }
+    Counters::Increment(COUNTER_OBJECTS_DRAWN, (int)sortedGameObjects.size());
+    redrawRequested = false;
+}
+
+void GameObjectManager::RequestRedraw() {
+    redrawRequested = true;
+}
+
+bool GameObjectManager::IsRedrawRequested() {
+    return redrawRequested;
+}
+
+void GameObjectManager::ScheduleUpdate(Uint32 ticks) {
+    if (nextScheduledUpdate == 0 || ticks < nextScheduledUpdate) {
+        nextScheduledUpdate = ticks;
+    }
+}
+
+Uint32 GameObjectManager::GetNextScheduledUpdate() {
+    return nextScheduledUpdate;
+}
+
+Uint64 GameObjectManager::GetUpdateCount() {
+    return updateCount;
 }
 
 #pragma endregion
@@ -274,6 +322,8 @@ Component::~Component() {}
 //     SpriteRenderer::renderer = renderer;
 // }
 
+SDL_Texture *SpriteRenderer::lastDrawnSpriteSheet = nullptr;
+
 SpriteRenderer::SpriteRenderer(GameObject *gameObject, Vector2 spriteSize, int drawOrder, SDL_Texture *defaultSpriteSheet) : Component(gameObject) {
     this->drawOrder = drawOrder;
 
@@ -313,9 +363,29 @@ void SpriteRenderer::Draw() {
     destRect.w = spriteRect.w * transform->scale.x;
     destRect.h = spriteRect.h * transform->scale.y;
 
-    // Copy the sprite to the renderer
-    // SDL_RenderCopy(renderer, spriteSheet, &spriteRect, &destRect);
-    SDL_RenderCopyEx(RENDERER, spriteSheet, &spriteRect, &destRect, transform->rotation, nullptr, SDL_FLIP_NONE);
+    SDL_Texture *drawnTexture = spriteSheet;
+    SDL_Texture *rotatedTexture;
+    SDL_Rect rotatedCell;
+    if (RotatedSpriteCache::GetInstance()->GetSprite(spriteSheet, spriteRect, transform->rotation, transform->scale, rotatedTexture, rotatedCell)) {
+        // Pre-rotated and pre-scaled cell, centred on the same point as the frame
+        destRect.w = rotatedCell.w;
+        destRect.h = rotatedCell.h;
+        destRect.x = transform->position.x - destRect.w / 2;
+        destRect.y = transform->position.y - destRect.h / 2;
+
+        SDL_RenderCopy(RENDERER, rotatedTexture, &rotatedCell, &destRect);
+        drawnTexture = rotatedTexture;
+    } else {
+        // Copy the sprite to the renderer
+        // SDL_RenderCopy(renderer, spriteSheet, &spriteRect, &destRect);
+        SDL_RenderCopyEx(RENDERER, spriteSheet, &spriteRect, &destRect, transform->rotation, nullptr, SDL_FLIP_NONE);
+    }
+
+    Counters::Increment(COUNTER_DRAW_CALLS);
+    if (drawnTexture != lastDrawnSpriteSheet) {
+        Counters::Increment(COUNTER_TEXTURE_SWITCHES);
+        lastDrawnSpriteSheet = drawnTexture;
+    }
 }
 
 Component *SpriteRenderer::Clone(GameObject *parent) {
@@ -324,28 +394,388 @@ Component *SpriteRenderer::Clone(GameObject *parent) {
     return newRenderer;
 }
 
-SDL_Texture *LoadSpriteSheet(std::string path) {
-    SDL_Surface *surface = IMG_Load(path.c_str());
-    if (!surface) {
+// Loaded sheets by path, every scene load asks for the same files again
+static std::map<std::string, SDL_Texture *> spriteSheetCache;
+
+bool GetModifiedTime(const std::string &path, time_t &modified) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+        return false;
+    modified = info.st_mtime;
+    return true;
+}
+
+// The converted blob of path if there is one at least as new as the image, see TexConv.cpp
+static SDL_Surface *LoadConvertedSurface(const std::string &path) {
+    std::string blobPath = GetTextureBlobPath(path);
+
+    // Packed blobs are converted from the images packed with them
+    if (!AssetArchive::GetInstance()->Contains(blobPath)) {
+        time_t imageTime, blobTime;
+        if (!GetModifiedTime(blobPath, blobTime))
+            return nullptr;
+        if (GetModifiedTime(path, imageTime) && blobTime < imageTime)
+            return nullptr;
+    }
+
+    SDL_Surface *surface = ReadTextureBlob(OpenAsset(blobPath));
+    if (!surface)
+        std::cerr << "Invalid texture blob, loading the image instead: " << blobPath << std::endl;
+    return surface;
+}
+
+SDL_Surface *LoadSpriteSurface(const std::string &path) {
+    SDL_Surface *surface = LoadConvertedSurface(path);
+    if (surface)
+        return surface;
+
+    surface = IMG_Load_RW(OpenAsset(path), 1);
+    if (!surface)
         std::cerr << "Failed to load image: " << path << std::endl;
+    return surface;
+}
+
+// Blobs are already in a format the renderer takes as is, they are uploaded without SDL picking and converting
+static SDL_Texture *CreateSpriteTexture(SDL_Surface *surface) {
+    if (surface->format->format != TEXTURE_BLOB_FORMAT)
+        return SDL_CreateTextureFromSurface(RENDERER, surface);
+
+    SDL_Texture *texture = SDL_CreateTexture(RENDERER, TEXTURE_BLOB_FORMAT, SDL_TEXTUREACCESS_STATIC, surface->w, surface->h);
+    if (!texture)
+        return nullptr;
+    if (SDL_UpdateTexture(texture, nullptr, surface->pixels, surface->pitch) != 0) {
+        SDL_DestroyTexture(texture);
         return nullptr;
     }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    return texture;
+}
 
-    SDL_Texture *texture = SDL_CreateTextureFromSurface(RENDERER, surface);
-    std::string error = SDL_GetError();
-    SDL_FreeSurface(surface);
+SDL_Texture *AddSpriteSheet(const std::string &key, SDL_Surface *surface) {
+    // Loaded synchronously in the meantime, keep the texture scenes may already hold
+    auto cached = spriteSheetCache.find(key);
+    if (cached != spriteSheetCache.end())
+        return cached->second;
+
+    SDL_Texture *texture = CreateSpriteTexture(surface);
+    if (!texture) {
+        std::cerr << "Failed to create texture: " << key << ": " << SDL_GetError() << std::endl;
+        return nullptr;
+    }
 
     TEXTURES.push_back(texture);
+    spriteSheetCache[key] = texture;
+
+    return texture;
+}
+
+SDL_Texture *LoadSpriteSheet(std::string path) {
+    auto cached = spriteSheetCache.find(path);
+    if (cached != spriteSheetCache.end())
+        return cached->second;
+
+    PROFILE_ZONE_DETAIL("LoadSpriteSheet", path.c_str());
+    SDL_Surface *surface = LoadSpriteSurface(path);
+    if (!surface)
+        return nullptr;
+
+    SDL_Texture *texture = AddSpriteSheet(path, surface);
+    SDL_FreeSurface(surface);
+
+    return texture;
+}
+
+// Averages every source pixel under each destination pixel, colours weighted by alpha so transparent pixels don't darken edges
+static SDL_Surface *BoxFilter(SDL_Surface *source, const SDL_Rect &region, int width, int height) {
+    SDL_Surface *result = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!result)
+        return nullptr;
+
+    for (int y = 0; y < height; y++) {
+        int sourceY0 = region.y + y * region.h / height;
+        int sourceY1 = std::max(sourceY0 + 1, region.y + (y + 1) * region.h / height);
+        Uint8 *row = (Uint8 *)result->pixels + y * result->pitch;
+
+        for (int x = 0; x < width; x++) {
+            int sourceX0 = region.x + x * region.w / width;
+            int sourceX1 = std::max(sourceX0 + 1, region.x + (x + 1) * region.w / width);
+
+            Uint64 red = 0, green = 0, blue = 0, alpha = 0;
+            int count = 0;
+            for (int sy = sourceY0; sy < sourceY1; sy++) {
+                const Uint8 *pixel = (const Uint8 *)source->pixels + sy * source->pitch + sourceX0 * 4;
+                for (int sx = sourceX0; sx < sourceX1; sx++, pixel += 4) {
+                    red += pixel[0] * pixel[3];
+                    green += pixel[1] * pixel[3];
+                    blue += pixel[2] * pixel[3];
+                    alpha += pixel[3];
+                    count++;
+                }
+            }
+
+            Uint8 *out = row + x * 4;
+            out[0] = alpha ? (Uint8)(red / alpha) : 0;
+            out[1] = alpha ? (Uint8)(green / alpha) : 0;
+            out[2] = alpha ? (Uint8)(blue / alpha) : 0;
+            out[3] = (Uint8)(alpha / count);
+        }
+    }
+
+    return result;
+}
+
+static void MakeDirectory(const std::string &path) {
+#ifdef _WIN32
+    _mkdir(path.c_str());
+#else
+    mkdir(path.c_str(), 0755);
+#endif
+}
+
+bool GetAssetModifiedTime(const std::string &path, time_t &modified) {
+    AssetArchive *archive = AssetArchive::GetInstance();
+    return GetModifiedTime(archive->Contains(path) ? archive->GetPath() : path, modified);
+}
+
+std::string GetAssetCachePath(const std::string &key, const std::string &extension) {
+    std::string name = key;
+    for (char &c : name) {
+        if (!isalnum((unsigned char)c))
+            c = '_';
+    }
+    MakeDirectory(ASSET_CACHE_DIR);
+    return ASSET_CACHE_DIR + name + extension;
+}
+
+std::string GetScaledSpriteSheetKey(const std::string &path, int width, int height, const SDL_Rect *region) {
+    std::string key = path + "@" + std::to_string(width) + "x" + std::to_string(height);
+    if (region) {
+        key += "/" + std::to_string(region->x) + "," + std::to_string(region->y) + "," +
+               std::to_string(region->w) + "," + std::to_string(region->h);
+    }
+    return key;
+}
+
+SDL_Surface *LoadScaledSurface(const std::string &path, int width, int height, const SDL_Rect *region) {
+    PROFILE_ZONE_DETAIL("LoadScaledSurface", path.c_str());
+
+    std::string cachePath = GetAssetCachePath(GetScaledSpriteSheetKey(path, width, height, region), ".bmp");
+
+    time_t sourceTime, cacheTime;
+    if (GetAssetModifiedTime(path, sourceTime) && GetModifiedTime(cachePath, cacheTime) && cacheTime >= sourceTime) {
+        SDL_Surface *cached = SDL_LoadBMP(cachePath.c_str());
+        if (cached)
+            return cached;
+    }
+
+    SDL_Surface *original = LoadSpriteSurface(path);
+    if (!original)
+        return nullptr;
+    SDL_Surface *source = SDL_ConvertSurfaceFormat(original, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(original);
+    if (!source) {
+        std::cerr << "Failed to convert image: " << path << ": " << SDL_GetError() << std::endl;
+        return nullptr;
+    }
+
+    SDL_Rect bounds = {0, 0, source->w, source->h};
+    SDL_Rect area = bounds;
+    if (region && !SDL_IntersectRect(region, &bounds, &area)) {
+        std::cerr << "Region outside of image: " << path << std::endl;
+        SDL_FreeSurface(source);
+        return nullptr;
+    }
+
+    SDL_Surface *surface = BoxFilter(source, area, width, height);
+    SDL_FreeSurface(source);
+    if (!surface) {
+        std::cerr << "Failed to scale image: " << path << ": " << SDL_GetError() << std::endl;
+        return nullptr;
+    }
+
+    if (SDL_SaveBMP(surface, cachePath.c_str()) != 0) {
+        std::cerr << "Failed to cache scaled image: " << cachePath << ": " << SDL_GetError() << std::endl;
+    }
+
+    return surface;
+}
+
+SDL_Texture *LoadSpriteSheetScaled(std::string path, int width, int height, const SDL_Rect *region) {
+    std::string key = GetScaledSpriteSheetKey(path, width, height, region);
+
+    auto cached = spriteSheetCache.find(key);
+    if (cached != spriteSheetCache.end())
+        return cached->second;
+
+    PROFILE_ZONE_DETAIL("LoadSpriteSheetScaled", path.c_str());
+    SDL_Surface *surface = LoadScaledSurface(path, width, height, region);
+    if (!surface)
+        return nullptr;
+
+    SDL_Texture *texture = AddSpriteSheet(key, surface);
+    SDL_FreeSurface(surface);
 
     return texture;
 }
 
+void ClearSpriteSheetCache() {
+    spriteSheetCache.clear();
+}
+
 int SpriteRenderer::GetDrawOrder() {
     return drawOrder;
 }
 
 #pragma endregion
 
+#pragma region RotatedSpriteCache
+
+// RotatedSpriteCache class implementation
+RotatedSpriteCache::RotatedSpriteCache() {}
+
+RotatedSpriteCache *RotatedSpriteCache::GetInstance() {
+    if (instance == nullptr) {
+        instance = new RotatedSpriteCache();
+    }
+    return instance;
+}
+
+void RotatedSpriteCache::SetAngleCount(int angleCount) {
+    this->angleCount = std::max(angleCount, 0);
+}
+
+int RotatedSpriteCache::GetAngleCount() {
+    return angleCount;
+}
+
+void RotatedSpriteCache::Prepare(SDL_Texture *sheet, Vector2 frameSize, Vector2 scale) {
+    if (angleCount == 0 || sheet == nullptr || RENDERER == nullptr || atlases.find(sheet) != atlases.end())
+        return;
+
+    if (!SDL_RenderTargetSupported(RENDERER)) {
+        std::cerr << "Renderer has no render targets, sprites are rotated at draw time" << std::endl;
+        angleCount = 0;
+        return;
+    }
+
+    PROFILE_ZONE("RotatedSpriteCache::Prepare");
+
+    // Same format as the sheet, so drawing from the atlas takes the same blit path
+    Uint32 format;
+    int sheetWidth, sheetHeight;
+    SDL_QueryTexture(sheet, &format, nullptr, &sheetWidth, &sheetHeight);
+
+    Atlas atlas;
+    atlas.frameWidth = (int)frameSize.x;
+    atlas.frameHeight = (int)frameSize.y;
+    atlas.scale = scale;
+    if (atlas.frameWidth <= 0 || atlas.frameHeight <= 0 || scale.x <= 0 || scale.y <= 0)
+        return;
+    atlas.columns = sheetWidth / atlas.frameWidth;
+    atlas.frameCount = atlas.columns * (sheetHeight / atlas.frameHeight);
+
+    float drawnWidth = atlas.frameWidth * scale.x, drawnHeight = atlas.frameHeight * scale.y;
+    atlas.cellSize = (int)std::ceil(std::sqrt(drawnWidth * drawnWidth + drawnHeight * drawnHeight));
+
+    int width = atlas.frameCount * atlas.cellSize;
+    int height = angleCount * atlas.cellSize;
+
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(RENDERER, &info) == 0 &&
+        ((info.max_texture_width && width > info.max_texture_width) ||
+         (info.max_texture_height && height > info.max_texture_height))) {
+        std::cerr << "Rotated sprite atlas too large (" << width << "x" << height << "), sheet is rotated at draw time" << std::endl;
+        return;
+    }
+
+    atlas.texture = SDL_CreateTexture(RENDERER, format, SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!atlas.texture) {
+        std::cerr << "Failed to create rotated sprite atlas: " << SDL_GetError() << std::endl;
+        return;
+    }
+    SDL_SetTextureBlendMode(atlas.texture, SDL_BLENDMODE_BLEND);
+
+    Render(sheet, atlas);
+
+    TEXTURES.push_back(atlas.texture);
+    atlases[sheet] = atlas;
+}
+
+void RotatedSpriteCache::Prepare(GameObject *gameObject) {
+    SpriteRenderer *spriteRenderer = gameObject->GetComponent<SpriteRenderer>();
+    if (spriteRenderer) {
+        Prepare(spriteRenderer->spriteSheet, Vector2(spriteRenderer->spriteRect.w, spriteRenderer->spriteRect.h), gameObject->transform.scale);
+    }
+}
+
+void RotatedSpriteCache::Render(SDL_Texture *sheet, Atlas &atlas) {
+    SDL_Texture *previousTarget = SDL_GetRenderTarget(RENDERER);
+    Uint8 red, green, blue, alpha;
+    SDL_GetRenderDrawColor(RENDERER, &red, &green, &blue, &alpha);
+    SDL_BlendMode sheetBlendMode;
+    SDL_GetTextureBlendMode(sheet, &sheetBlendMode);
+
+    SDL_SetRenderTarget(RENDERER, atlas.texture);
+    SDL_SetRenderDrawColor(RENDERER, 0, 0, 0, 0);
+    SDL_RenderClear(RENDERER);
+
+    // Copy the pixels as they are, blending onto the transparent atlas would darken soft edges
+    SDL_SetTextureBlendMode(sheet, SDL_BLENDMODE_NONE);
+
+    int drawnWidth = (int)(atlas.frameWidth * atlas.scale.x), drawnHeight = (int)(atlas.frameHeight * atlas.scale.y);
+    for (int angle = 0; angle < angleCount; angle++) {
+        for (int frame = 0; frame < atlas.frameCount; frame++) {
+            SDL_Rect source = {(frame % atlas.columns) * atlas.frameWidth, (frame / atlas.columns) * atlas.frameHeight,
+                               atlas.frameWidth, atlas.frameHeight};
+            SDL_Rect destination = {frame * atlas.cellSize + (atlas.cellSize - drawnWidth) / 2,
+                                    angle * atlas.cellSize + (atlas.cellSize - drawnHeight) / 2,
+                                    drawnWidth, drawnHeight};
+            SDL_RenderCopyEx(RENDERER, sheet, &source, &destination, angle * 360.0 / angleCount, nullptr, SDL_FLIP_NONE);
+        }
+    }
+
+    SDL_SetTextureBlendMode(sheet, sheetBlendMode);
+    SDL_SetRenderTarget(RENDERER, previousTarget);
+    SDL_SetRenderDrawColor(RENDERER, red, green, blue, alpha);
+}
+
+bool RotatedSpriteCache::GetSprite(SDL_Texture *sheet, const SDL_Rect &frame, float rotation, Vector2 scale, SDL_Texture *&texture, SDL_Rect &cell) {
+    if (atlases.empty())
+        return false;
+
+    auto found = atlases.find(sheet);
+    if (found == atlases.end())
+        return false;
+
+    Atlas &atlas = found->second;
+    if (frame.w != atlas.frameWidth || frame.h != atlas.frameHeight || !(scale == atlas.scale))
+        return false;
+
+    int index = (frame.y / atlas.frameHeight) * atlas.columns + frame.x / atlas.frameWidth;
+    if (index < 0 || index >= atlas.frameCount)
+        return false;
+
+    int angle = (int)std::floor(rotation * angleCount / 360.0f + 0.5f) % angleCount;
+    if (angle < 0)
+        angle += angleCount;
+
+    texture = atlas.texture;
+    cell = {index * atlas.cellSize, angle * atlas.cellSize, atlas.cellSize, atlas.cellSize};
+    return true;
+}
+
+void RotatedSpriteCache::Rebuild() {
+    for (auto &pair : atlases) {
+        Render(pair.first, pair.second);
+    }
+}
+
+void RotatedSpriteCache::Clear() {
+    atlases.clear();
+}
+
+#pragma endregion
+
 #pragma region Animator
 // AnimationClip class implementation
 
@@ -419,8 +849,10 @@ void AnimationClip::AdvanceFrame() {
         return;
 
     float currentTime = SDL_GetTicks();
-    if (currentTime - lastFrameTime <= animCooldown / speedScale)
+    if (currentTime - lastFrameTime <= animCooldown / speedScale) {
+        GameObjectManager::GetInstance()->ScheduleUpdate((Uint32)(lastFrameTime + animCooldown / speedScale) + 1);
         return;
+    }
 
     lastFrameTime = currentTime;
     currentSprite++;
@@ -439,6 +871,11 @@ void AnimationClip::AdvanceFrame() {
 
     currentSpriteRect.x = currentSprite * spriteSize.x;
     currentSpriteRect.y = 0;
+
+    GameObjectManager::GetInstance()->RequestRedraw();
+    if (isPlaying) {
+        GameObjectManager::GetInstance()->ScheduleUpdate((Uint32)(lastFrameTime + animCooldown / speedScale) + 1);
+    }
 }
 
 void AnimationClip::Ready() {
@@ -446,6 +883,7 @@ void AnimationClip::Ready() {
     isPlaying = true;
     startTime = SDL_GetTicks();
     lastFrameTime = SDL_GetTicks() - animCooldown * speedScale;
+    GameObjectManager::GetInstance()->RequestRedraw();
 }
 
 std::pair<SDL_Texture *, SDL_Rect> AnimationClip::GetCurrentSpriteInfo() {
@@ -548,7 +986,16 @@ void Scene::RunLogic() {
     }
 }
 
+void Scene::SetStatic(bool isStatic) {
+    this->isStatic = isStatic;
+}
+
+bool Scene::IsStatic() {
+    return isStatic;
+}
+
 void Scene::Load() {
+    PROFILE_ZONE_DETAIL("Scene::Load", name.c_str());
     // Clear all objects
     GameObjectManager::GetInstance()->Clear();
     CollisionManager::GetInstance()->Clear();
@@ -613,6 +1060,7 @@ Scene *SceneManager::GetCurrentScene() {
 }
 
 void SceneManager::Update() {
+    PROFILE_ZONE("SceneManager::Update");
     CollisionManager::GetInstance()->Update();
     GameObjectManager::GetInstance()->Update();
 }
@@ -623,6 +1071,316 @@ void SceneManager::Draw() {
 
 #pragma endregion
 
+#pragma region InputManager
+
+// InputManager class implementation
+InputManager::InputManager() {
+    for (int i = 0; i < SDL_NUM_SCANCODES; i++) {
+        keysHeld[i] = false;
+        keysPressed[i] = keysReleased[i] = 0;
+    }
+    for (int i = 0; i < MOUSE_BUTTON_COUNT; i++) {
+        mouseHeld[i] = false;
+        mousePressed[i] = mouseReleased[i] = 0;
+    }
+    SetDefaultBindings();
+}
+
+InputManager *InputManager::GetInstance() {
+    if (instance == nullptr) {
+        instance = new InputManager();
+    }
+    return instance;
+}
+
+void InputManager::SetDefaultBindings() {
+    for (int player = 0; player < PLAYER_COUNT; player++) {
+        for (int action = 0; action < ACTION_COUNT; action++) {
+            bindings[player][action] = SDL_SCANCODE_UNKNOWN;
+        }
+    }
+
+    bindings[0][ACTION_MOVE_UP] = SDL_SCANCODE_W;
+    bindings[0][ACTION_MOVE_DOWN] = SDL_SCANCODE_S;
+    bindings[0][ACTION_MOVE_LEFT] = SDL_SCANCODE_A;
+    bindings[0][ACTION_MOVE_RIGHT] = SDL_SCANCODE_D;
+    bindings[0][ACTION_KICK] = SDL_SCANCODE_SPACE;
+    bindings[0][ACTION_SWITCH_PLAYER_1] = SDL_SCANCODE_1;
+    bindings[0][ACTION_SWITCH_PLAYER_2] = SDL_SCANCODE_2;
+    bindings[0][ACTION_SWITCH_PLAYER_3] = SDL_SCANCODE_3;
+
+    bindings[1][ACTION_MOVE_UP] = SDL_SCANCODE_UP;
+    bindings[1][ACTION_MOVE_DOWN] = SDL_SCANCODE_DOWN;
+    bindings[1][ACTION_MOVE_LEFT] = SDL_SCANCODE_LEFT;
+    bindings[1][ACTION_MOVE_RIGHT] = SDL_SCANCODE_RIGHT;
+    bindings[1][ACTION_KICK] = SDL_SCANCODE_KP_ENTER;
+    bindings[1][ACTION_SWITCH_PLAYER_1] = SDL_SCANCODE_KP_6;
+    bindings[1][ACTION_SWITCH_PLAYER_2] = SDL_SCANCODE_KP_4;
+    bindings[1][ACTION_SWITCH_PLAYER_3] = SDL_SCANCODE_KP_5;
+
+    bindings[0][ACTION_MENU] = SDL_SCANCODE_ESCAPE;
+    bindings[0][ACTION_DUMP_TRACE] = SDL_SCANCODE_F9;
+    bindings[0][ACTION_DUMP_COUNTERS] = SDL_SCANCODE_F10;
+    bindings[0][ACTION_TOGGLE_COUNTERS] = SDL_SCANCODE_F3;
+    bindings[0][ACTION_RELOAD_BINDINGS] = SDL_SCANCODE_F5;
+}
+
+void InputManager::BeginTick() {
+    tick++;
+}
+
+void InputManager::ProcessEvent(const SDL_Event &event) {
+    switch (event.type) {
+    case SDL_KEYDOWN: {
+        SDL_Scancode scancode = event.key.keysym.scancode;
+        if (event.key.repeat || keysHeld[scancode])
+            break;
+        keysHeld[scancode] = true;
+        keysPressed[scancode] = tick;
+        DispatchKey(scancode, true);
+        break;
+    }
+    case SDL_KEYUP: {
+        SDL_Scancode scancode = event.key.keysym.scancode;
+        if (!keysHeld[scancode])
+            break;
+        keysHeld[scancode] = false;
+        keysReleased[scancode] = tick;
+        DispatchKey(scancode, false);
+        break;
+    }
+    case SDL_MOUSEBUTTONDOWN:
+        if (event.button.button < MOUSE_BUTTON_COUNT) {
+            mouseHeld[event.button.button] = true;
+            mousePressed[event.button.button] = tick;
+        }
+        mousePosition = mousePressPosition = Vector2(event.button.x, event.button.y);
+        if (event.button.button == SDL_BUTTON_LEFT) {
+            for (auto &subscription : clickSubscribers) {
+                subscription.handler(mousePressPosition);
+            }
+        }
+        break;
+    case SDL_MOUSEBUTTONUP:
+        if (event.button.button < MOUSE_BUTTON_COUNT) {
+            mouseHeld[event.button.button] = false;
+            mouseReleased[event.button.button] = tick;
+        }
+        mousePosition = Vector2(event.button.x, event.button.y);
+        break;
+    case SDL_MOUSEMOTION:
+        mousePosition = Vector2(event.motion.x, event.motion.y);
+        break;
+    case SDL_WINDOWEVENT:
+        // Key ups get lost while unfocused, don't leave keys stuck down
+        if (event.window.event == SDL_WINDOWEVENT_FOCUS_LOST) {
+            for (int i = 0; i < SDL_NUM_SCANCODES; i++) {
+                if (keysHeld[i]) {
+                    keysHeld[i] = false;
+                    keysReleased[i] = tick;
+                    DispatchKey((SDL_Scancode)i, false);
+                }
+            }
+            for (int i = 0; i < MOUSE_BUTTON_COUNT; i++) {
+                mouseHeld[i] = false;
+            }
+        }
+        break;
+    }
+}
+
+void InputManager::DispatchKey(SDL_Scancode scancode, bool pressed) {
+    for (int player = 0; player < PLAYER_COUNT; player++) {
+        for (int action = 0; action < ACTION_COUNT; action++) {
+            if (bindings[player][action] == scancode) {
+                DispatchAction(player, (InputAction)action, pressed);
+            }
+        }
+    }
+}
+
+void InputManager::DispatchAction(int player, InputAction action, bool pressed) {
+    for (auto &subscription : actionSubscribers[player][action]) {
+        subscription.handler(pressed);
+    }
+}
+
+bool InputManager::GetKey(SDL_Keycode key) {
+    return keysHeld[SDL_GetScancodeFromKey(key)];
+}
+
+bool InputManager::GetKeyDown(SDL_Keycode key) {
+    return keysPressed[SDL_GetScancodeFromKey(key)] == tick;
+}
+
+bool InputManager::GetKeyUp(SDL_Keycode key) {
+    return keysReleased[SDL_GetScancodeFromKey(key)] == tick;
+}
+
+bool InputManager::GetMouseButton(int button) {
+    return button >= 0 && button < MOUSE_BUTTON_COUNT && mouseHeld[button];
+}
+
+bool InputManager::GetMouseButtonDown(int button) {
+    return button >= 0 && button < MOUSE_BUTTON_COUNT && mousePressed[button] == tick;
+}
+
+bool InputManager::GetMouseButtonUp(int button) {
+    return button >= 0 && button < MOUSE_BUTTON_COUNT && mouseReleased[button] == tick;
+}
+
+Vector2 InputManager::GetMousePosition() {
+    return mousePosition;
+}
+
+Vector2 InputManager::GetMousePressPosition() {
+    return mousePressPosition;
+}
+
+int InputManager::Subscribe(int player, InputAction action, ActionHandler handler) {
+    if (player < 0 || player >= PLAYER_COUNT || action < 0 || action >= ACTION_COUNT) {
+        std::cerr << "Invalid input subscription: player " << player << ", action " << action << std::endl;
+        return 0;
+    }
+    int id = nextSubscriptionId++;
+    actionSubscribers[player][action].push_back({id, handler});
+    return id;
+}
+
+int InputManager::SubscribeClick(ClickHandler handler) {
+    int id = nextSubscriptionId++;
+    clickSubscribers.push_back({id, handler});
+    return id;
+}
+
+void InputManager::Unsubscribe(int id) {
+    for (auto &player : actionSubscribers) {
+        for (auto &subscribers : player) {
+            for (auto it = subscribers.begin(); it != subscribers.end(); ++it) {
+                if (it->id == id) {
+                    subscribers.erase(it);
+                    return;
+                }
+            }
+        }
+    }
+    for (auto it = clickSubscribers.begin(); it != clickSubscribers.end(); ++it) {
+        if (it->id == id) {
+            clickSubscribers.erase(it);
+            return;
+        }
+    }
+}
+
+bool InputManager::GetAction(int player, InputAction action) {
+    SDL_Scancode scancode = bindings[player][action];
+    return scancode != SDL_SCANCODE_UNKNOWN && keysHeld[scancode];
+}
+
+void InputManager::Bind(int player, InputAction action, SDL_Scancode scancode) {
+    if (bindings[player][action] == scancode)
+        return;
+    if (GetAction(player, action)) {
+        DispatchAction(player, action, false);
+    }
+    bindings[player][action] = scancode;
+}
+
+SDL_Scancode InputManager::GetBinding(int player, InputAction action) {
+    return bindings[player][action];
+}
+
+const char *InputManager::GetActionName(InputAction action) {
+    switch (action) {
+    case ACTION_MOVE_UP:
+        return "MoveUp";
+    case ACTION_MOVE_DOWN:
+        return "MoveDown";
+    case ACTION_MOVE_LEFT:
+        return "MoveLeft";
+    case ACTION_MOVE_RIGHT:
+        return "MoveRight";
+    case ACTION_KICK:
+        return "Kick";
+    case ACTION_SWITCH_PLAYER_1:
+        return "SwitchPlayer1";
+    case ACTION_SWITCH_PLAYER_2:
+        return "SwitchPlayer2";
+    case ACTION_SWITCH_PLAYER_3:
+        return "SwitchPlayer3";
+    case ACTION_MENU:
+        return "Menu";
+    case ACTION_DUMP_TRACE:
+        return "DumpTrace";
+    case ACTION_DUMP_COUNTERS:
+        return "DumpCounters";
+    case ACTION_TOGGLE_COUNTERS:
+        return "ToggleCounters";
+    case ACTION_RELOAD_BINDINGS:
+        return "ReloadBindings";
+    default:
+        return "Unknown";
+    }
+}
+
+static std::string Trim(const std::string &text) {
+    size_t start = text.find_first_not_of(" \t\r");
+    if (start == std::string::npos)
+        return "";
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(start, end - start + 1);
+}
+
+bool InputManager::LoadBindings(const std::string &path) {
+    PROFILE_ZONE_DETAIL("InputManager::LoadBindings", path.c_str());
+
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Failed to open input bindings: " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        line = Trim(line.substr(0, line.find('#')));
+        if (line.empty())
+            continue;
+
+        size_t equals = line.find('=');
+        std::istringstream left(line.substr(0, equals));
+        std::string scope, actionName;
+        left >> scope >> actionName;
+        std::string keyName = equals == std::string::npos ? "" : Trim(line.substr(equals + 1));
+
+        int player = -1;
+        if (scope == "player1" || scope == "global") {
+            player = 0;
+        } else if (scope == "player2") {
+            player = 1;
+        }
+
+        int action = 0;
+        while (action < ACTION_COUNT && actionName != GetActionName((InputAction)action)) {
+            action++;
+        }
+
+        SDL_Scancode scancode = SDL_GetScancodeFromName(keyName.c_str());
+
+        if (player == -1 || action == ACTION_COUNT || scancode == SDL_SCANCODE_UNKNOWN) {
+            std::cerr << path << ":" << lineNumber << ": invalid binding \"" << line << "\"" << std::endl;
+            continue;
+        }
+
+        Bind(player, (InputAction)action, scancode);
+    }
+
+    return true;
+}
+
+#pragma endregion
+
 #pragma region SoundManager
 
 // SoundManager class implementation
@@ -630,18 +1388,48 @@ SoundManager::SoundManager() {
     if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 1024) < 0) {
         std::cerr << "SDL_mixer could not initialize! SDL_mixer Error: " << Mix_GetError() << std::endl;
     }
+    Mix_AllocateChannels(VOICE_COUNT + 1);
+    // Needs the device format
+    AudioCache::GetInstance();
+
+    fieldWidth = WIDTH;
+    BuildPanTable();
+}
+
+void SoundManager::BuildPanTable() {
+    // How far to the side the edges are panned, hard left/right sounds odd on speakers
+    const float spread = 0.75f;
+    // Gain at the edges, the listener is at the centre of the field
+    const float edgeGain = 0.7f;
+
+    for (int step = 0; step < PAN_STEPS; step++) {
+        float offset = ((step + 0.5f) / PAN_STEPS) * 2 - 1;
+        float gain = 1 - (1 - edgeGain) * std::fabs(offset);
+
+        // Equal power, scaled so the centre stays at full volume like an unpanned sound
+        float angle = (offset * spread + 1) * (float)M_PI / 4;
+        float left = std::min(1.0f, std::cos(angle) / std::cos((float)M_PI / 4));
+        float right = std::min(1.0f, std::sin(angle) / std::sin((float)M_PI / 4));
+
+        panTable[step].left = (Uint8)(255 * left * gain);
+        panTable[step].right = (Uint8)(255 * right * gain);
+    }
 }
 
 SoundManager::~SoundManager() {
     for (auto &pair : music) {
-        Mix_FreeMusic(pair.second);
+        Mix_FreeChunk(pair.second);
     }
     music.clear();
 
-    for (auto &pair : sounds) {
-        Mix_FreeChunk(pair.second);
+    for (auto &sound : sounds) {
+        if (sound.chunk)
+            Mix_FreeChunk(sound.chunk);
     }
     sounds.clear();
+    soundIds.clear();
+
+    delete AudioCache::GetInstance();
 
     Mix_Quit();
 
@@ -656,23 +1444,61 @@ SoundManager* SoundManager::GetInstance() {
 }
 
 void SoundManager::AddMusic(std::string name, std::string path, int volume = 128) {
-    Mix_Music *newMusic = Mix_LoadMUS(path.c_str());
-    if (!newMusic) {
-        std::cerr << "Failed to load music: " << path << " SDL_mixer Error: " << Mix_GetError() << std::endl;
-        return;
+    PROFILE_ZONE_DETAIL("AddMusic", path.c_str());
+    Mix_Chunk *newMusic = AudioCache::GetInstance()->Load(path);
+    if (newMusic)
+        AddMusic(name, newMusic, volume);
+}
+
+void SoundManager::AddMusic(std::string name, Mix_Chunk *newMusic, int volume) {
+    auto existing = music.find(name);
+    if (existing != music.end() && existing->second != newMusic) {
+        if (currentMusic == name) {
+            Mix_HaltChannel(MUSIC_CHANNEL);
+            currentMusic.clear();
+        }
+        Mix_FreeChunk(existing->second);
     }
     music[name] = newMusic;
     musicVolumes[name] = volume;
 }
 
-void SoundManager::AddSound(std::string name, std::string path, int volume = 128) {
-    Mix_Chunk *newSound = Mix_LoadWAV(path.c_str());
-    if (!newSound) {
-        std::cerr << "Failed to load sound: " << path << " SDL_mixer Error: " << Mix_GetError() << std::endl;
-        return;
+void SoundManager::AddSound(std::string name, std::string path, int volume, int priority) {
+    PROFILE_ZONE_DETAIL("AddSound", path.c_str());
+    Mix_Chunk *newSound = AudioCache::GetInstance()->Load(path);
+    if (newSound)
+        AddSound(name, newSound, volume, priority);
+}
+
+void SoundManager::AddSound(std::string name, Mix_Chunk *newSound, int volume, int priority) {
+    SoundId id = GetSoundId(name);
+    Sound &sound = sounds[id];
+
+    if (sound.chunk && sound.chunk != newSound) {
+        // The old chunk may still be playing
+        for (int channel = 0; channel < VOICE_COUNT; channel++) {
+            if (voices[channel].sound == id)
+                Mix_HaltChannel(channel);
+        }
+        Mix_FreeChunk(sound.chunk);
     }
-    sounds[name] = newSound;
-    soundVolumes[name] = volume;
+
+    sound.chunk = newSound;
+    sound.volume = volume;
+    sound.priority = priority;
+}
+
+SoundId SoundManager::GetSoundId(const std::string &name) {
+    auto it = soundIds.find(name);
+    if (it != soundIds.end())
+        return it->second;
+
+    SoundId id = (SoundId)sounds.size();
+    Sound sound;
+    sound.name = name;
+    sounds.push_back(sound);
+    soundIds[name] = id;
+    return id;
 }
 
 void SoundManager::PlayMusic(std::string name, int loops) {
@@ -683,47 +1509,171 @@ void SoundManager::PlayMusic(std::string name, int loops) {
         }
         
         currentMusic = name;
-        Mix_VolumeMusic(musicVolumes[name]);
-        Mix_PlayMusic(it->second, loops);
+        Mix_Volume(MUSIC_CHANNEL, musicVolumes[name]);
+        Mix_PlayChannel(MUSIC_CHANNEL, it->second, loops);
     } else {
         std::cerr << "Music not found: " << name << std::endl;
     }
 }
 
-void SoundManager::PlaySound(std::string name, int loops) {
-    auto it = sounds.find(name);
-    if (it != sounds.end()) {
+int SoundManager::AllocateVoice(int priority) {
+    int victim = -1;
+    for (int channel = 0; channel < VOICE_COUNT; channel++) {
+        if (!Mix_Playing(channel))
+            return channel;
 
-        Mix_Volume(-1, soundVolumes[name]);
-        Mix_PlayChannel(-1, it->second, loops);
-        
-    } else {
+        Voice &voice = voices[channel];
+        if (voice.priority > priority)
+            continue;
+        if (victim < 0 || voice.priority < voices[victim].priority ||
+            (voice.priority == voices[victim].priority && voice.startTime < voices[victim].startTime)) {
+            victim = channel;
+        }
+    }
+
+    if (victim >= 0)
+        Counters::Increment(COUNTER_VOICES_STOLEN);
+    return victim;
+}
+
+void SoundManager::SetSoundLimits(SoundId id, Uint32 coalesceWindowMs, int maxInstances) {
+    if (id < 0 || id >= (SoundId)sounds.size())
+        return;
+    sounds[id].coalesceWindow = coalesceWindowMs;
+    sounds[id].maxInstances = maxInstances;
+}
+
+SoundManager::Request *SoundManager::Queue(SoundId id, int loops) {
+    if (id < 0 || id >= (SoundId)sounds.size() || !sounds[id].chunk)
+        return nullptr;
+
+    Sound &sound = sounds[id];
+    if (sound.request >= 0) {
+        Counters::Increment(COUNTER_SOUNDS_COALESCED);
+        return &requests[sound.request];
+    }
+    sound.request = (int)requests.size();
+    Request request;
+    request.sound = id;
+    request.loops = loops;
+    requests.push_back(request);
+    return &requests.back();
+}
+
+void SoundManager::PlaySound(SoundId id, int loops) {
+    Queue(id, loops);
+}
+
+void SoundManager::PlaySound(SoundId id, Vector2 position, int loops) {
+    Request *request = Queue(id, loops);
+    if (request) {
+        request->positionSum += position.x;
+        request->positionCount++;
+    }
+}
+
+int SoundManager::CountInstances(SoundId id) {
+    int count = 0;
+    for (int channel = 0; channel < VOICE_COUNT; channel++) {
+        if (voices[channel].sound == id && Mix_Playing(channel))
+            count++;
+    }
+    return count;
+}
+
+void SoundManager::Start(SoundId id, int loops, int panStep) {
+    Sound &sound = sounds[id];
+    int channel = AllocateVoice(sound.priority);
+    if (channel < 0) {
+        Counters::Increment(COUNTER_SOUNDS_DROPPED);
+        return;
+    }
+
+    // Playing on a busy channel halts what was there
+    Mix_Volume(channel, sound.volume);
+    // 255 on both sides removes the previous sound's panning
+    if (panStep >= 0)
+        Mix_SetPanning(channel, panTable[panStep].left, panTable[panStep].right);
+    else
+        Mix_SetPanning(channel, 255, 255);
+    if (Mix_PlayChannel(channel, sound.chunk, loops) < 0)
+        return;
+
+    voices[channel].sound = id;
+    voices[channel].priority = sound.priority;
+    voices[channel].startTime = SDL_GetTicks();
+    sound.lastStartTime = voices[channel].startTime;
+    Counters::Increment(COUNTER_SOUNDS_PLAYED);
+}
+
+void SoundManager::Flush() {
+    if (requests.empty())
+        return;
+
+    // Important sounds pick their voices first
+    std::sort(requests.begin(), requests.end(), [this](const Request &a, const Request &b) {
+        return sounds[a.sound].priority > sounds[b.sound].priority;
+    });
+
+    Uint32 now = SDL_GetTicks();
+    for (auto &request : requests) {
+        Sound &sound = sounds[request.sound];
+        sound.request = -1;
+
+        bool recentlyStarted = sound.lastStartTime != 0 && now - sound.lastStartTime < sound.coalesceWindow;
+        if (!sound.chunk || recentlyStarted || CountInstances(request.sound) >= sound.maxInstances) {
+            Counters::Increment(COUNTER_SOUNDS_COALESCED);
+            continue;
+        }
+
+        int panStep = -1;
+        if (request.positionCount > 0) {
+            float x = request.positionSum / request.positionCount;
+            panStep = std::max(0, std::min(PAN_STEPS - 1, (int)(x * PAN_STEPS / fieldWidth)));
+        }
+        Start(request.sound, request.loops, panStep);
+    }
+    requests.clear();
+}
+
+void SoundManager::PlaySound(const std::string &name, int loops) {
+    auto it = soundIds.find(name);
+    if (it == soundIds.end()) {
         std::cerr << "Sound not found: " << name << std::endl;
+        return;
     }
+    PlaySound(it->second, loops);
 }
 
 void SoundManager::StopMusic() {
-    Mix_HaltMusic();
+    Mix_HaltChannel(MUSIC_CHANNEL);
 }
 
+// -1 would take the music channel along
 void SoundManager::StopSound() {
-    Mix_HaltChannel(-1);
+    for (int channel = 0; channel < VOICE_COUNT; channel++) {
+        Mix_HaltChannel(channel);
+    }
 }
 
 void SoundManager::PauseMusic() {
-    Mix_PauseMusic();
+    Mix_Pause(MUSIC_CHANNEL);
 }
 
 void SoundManager::PauseSound() {
-    Mix_Pause(-1);
+    for (int channel = 0; channel < VOICE_COUNT; channel++) {
+        Mix_Pause(channel);
+    }
 }
 
 void SoundManager::ResumeMusic() {
-    Mix_ResumeMusic();
+    Mix_Resume(MUSIC_CHANNEL);
 }
 
 void SoundManager::ResumeSound() {
-    Mix_Resume(-1);
+    for (int channel = 0; channel < VOICE_COUNT; channel++) {
+        Mix_Resume(channel);
+    }
 }
 
 
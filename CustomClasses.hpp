@@ -11,6 +11,8 @@
 
 #include <SDL2/SDL_mixer.h>
 
+#include "Profiler.hpp"
+
 class GameObject;
 
 // Event
@@ -93,6 +95,13 @@ Vector2 operator*(float f, Vector2 v);
 class GameObjectManager {
 private:
     std::map<std::string, GameObject *> gameObjects;
+
+    // Idle support for static scenes, see Scene::SetStatic
+    bool redrawRequested = true;
+    Uint32 nextScheduledUpdate = 0;
+
+    Uint64 updateCount = 0;
+
     GameObjectManager();
     static GameObjectManager *instance;
 public:
@@ -109,6 +118,15 @@ public:
     void Update();
     void Draw();
 
+    // Something visible changed, cleared by Draw
+    void RequestRedraw();
+    bool IsRedrawRequested();
+    // Asks for an update at SDL_GetTicks() time ticks, e.g. the next animation frame. Reset by every Update
+    void ScheduleUpdate(Uint32 ticks);
+    // Earliest scheduled update, 0 if none
+    Uint32 GetNextScheduledUpdate();
+    // Number of Update calls so far, the running one included. Tells per-tick caches when to refresh.
+    Uint64 GetUpdateCount();
 };
 
 class Component {
@@ -123,12 +141,38 @@ public:
     virtual Component *Clone(GameObject *parent) = 0;
 };
 
+// Loads each path once, later calls return the same texture. Uses the converted blob of the image when there is one.
 SDL_Texture *LoadSpriteSheet(std::string path);
+// Decodes the image (or its blob) without touching the renderer, worker threads may call it
+SDL_Surface *LoadSpriteSurface(const std::string &path);
+/*Import step for images drawn much smaller than their file: crops path to region (the whole image if null)
+and box-filters it down to width x height, so the renderer doesn't scale a huge texture every frame.
+The result is cached as BMP in ASSET_CACHE_DIR and reused while it is newer than the source.
+*/
+SDL_Texture *LoadSpriteSheetScaled(std::string path, int width, int height, const SDL_Rect *region = nullptr);
+// Cache key LoadSpriteSheetScaled stores its result under
+std::string GetScaledSpriteSheetKey(const std::string &path, int width, int height, const SDL_Rect *region = nullptr);
+// The decoding half of LoadSpriteSheetScaled, doesn't touch the renderer so worker threads may call it
+SDL_Surface *LoadScaledSurface(const std::string &path, int width, int height, const SDL_Rect *region = nullptr);
+// Uploads a decoded image and caches it under key, main thread only. Returns the cached texture if key is already loaded.
+SDL_Texture *AddSpriteSheet(const std::string &key, SDL_Surface *surface);
+// Forgets the loaded sheets, the textures themselves are destroyed with TEXTURES
+void ClearSpriteSheetCache();
+
+// Last modification of a file, false if it doesn't exist
+bool GetModifiedTime(const std::string &path, time_t &modified);
+// Same for an asset, a packed one is as old as its archive
+bool GetAssetModifiedTime(const std::string &path, time_t &modified);
+// File in ASSET_CACHE_DIR for something imported from key, creates the directory
+std::string GetAssetCachePath(const std::string &key, const std::string &extension);
 
 class SpriteRenderer : public Component {
 private:
     int drawOrder = 0;
 
+    // Sheet of the previous draw call, to count texture switches
+    static SDL_Texture *lastDrawnSpriteSheet;
+
 public:
     SDL_Texture *spriteSheet = nullptr;
     SDL_Rect spriteRect;
@@ -146,6 +190,53 @@ public:
     int GetDrawOrder();
 };
 
+/*Singleton store of sprite sheets pre-rendered at evenly spaced angles, for renderers where rotated copies
+are much slower than plain ones (software rendering, headless capture).
+Each prepared sheet gets an atlas with one row per angle and one square cell per frame, the cell fits the frame's diagonal.
+Frames are pre-rendered at the scale they are drawn at, SpriteRenderer::Draw then copies the nearest angle
+without rotating or scaling (scaled blended copies are slow on the software renderer too).
+Off while the angle count is 0, sheets that weren't prepared or are drawn at another scale keep rotating at draw time.
+*/
+class RotatedSpriteCache {
+private:
+    struct Atlas {
+        SDL_Texture *texture = nullptr;
+        int frameWidth = 0, frameHeight = 0;
+        Vector2 scale;
+        int columns = 0, frameCount = 0;
+        int cellSize = 0;
+    };
+
+    std::map<SDL_Texture *, Atlas> atlases;
+    int angleCount = 0;
+
+    void Render(SDL_Texture *sheet, Atlas &atlas);
+
+    RotatedSpriteCache();
+    static RotatedSpriteCache *instance;
+
+public:
+    static RotatedSpriteCache *GetInstance();
+
+    // Set before preparing sheets, 0 turns the cache off
+    void SetAngleCount(int angleCount);
+    int GetAngleCount();
+
+    // Builds the atlas of a sheet cut into frameSize frames drawn at scale, call at load time
+    void Prepare(SDL_Texture *sheet, Vector2 frameSize, Vector2 scale);
+    // Prepares the sheet currently shown by the object's SpriteRenderer, at the object's scale
+    void Prepare(GameObject *gameObject);
+
+    // Atlas texture and cell for a frame of sheet at rotation degrees, the cell is drawn at its own size.
+    // false if the sheet isn't prepared for this scale
+    bool GetSprite(SDL_Texture *sheet, const SDL_Rect &frame, float rotation, Vector2 scale, SDL_Texture *&texture, SDL_Rect &cell);
+
+    // Redraws the atlases after the renderer lost its render targets
+    void Rebuild();
+    // Forgets the atlases, the textures themselves are destroyed with TEXTURES
+    void Clear();
+};
+
 class AnimationClip {
 private:
     SDL_Texture *spriteSheet;
@@ -237,6 +328,7 @@ public:
 
 template <typename T>
 T *GameObject::GetComponent() {
+    Counters::Increment(COUNTER_GET_COMPONENT);
     for (auto &component : components) {
         if (dynamic_cast<T *>(component)) {
             return dynamic_cast<T *>(component);
@@ -252,6 +344,8 @@ private:
 
     std::function<void()> logic;
 
+    bool isStatic = false;
+
 public:
     Scene(std::string name);
     ~Scene();
@@ -262,6 +356,12 @@ public:
     void Load();
 
     std::string GetName();
+
+    /*A static scene only changes on input and animation frames, like a menu.
+    The main loop may then block until one of those instead of running at full rate.
+    */
+    void SetStatic(bool isStatic);
+    bool IsStatic();
 };
 
 // Wrapper for all, including GameObjectManager
@@ -292,16 +392,206 @@ public:
     void Draw();
 };
 
-class SoundManager {
+// What input means to the game, keys are bound to these per player
+enum InputAction {
+    ACTION_MOVE_UP,
+    ACTION_MOVE_DOWN,
+    ACTION_MOVE_LEFT,
+    ACTION_MOVE_RIGHT,
+    ACTION_KICK,
+    ACTION_SWITCH_PLAYER_1,
+    ACTION_SWITCH_PLAYER_2,
+    ACTION_SWITCH_PLAYER_3,
+    // Global actions, bound for player 0
+    ACTION_MENU,
+    ACTION_DUMP_TRACE,
+    ACTION_DUMP_COUNTERS,
+    ACTION_TOGGLE_COUNTERS,
+    ACTION_RELOAD_BINDINGS,
+    ACTION_COUNT
+};
+
+/*Singleton input snapshot, rebuilt once per tick from the whole SDL event queue.
+Holds the held state of keys and mouse buttons plus the pressed/released edges of the tick.
+Keys are mapped to actions per player by bindings loaded from a config file (Assets/Config/input.cfg).
+Components subscribe to actions and are only called when one changes, frames without input do no input work.
+*/
+class InputManager {
+public:
+    static const int PLAYER_COUNT = 2;
+
+    // pressed is false when the action is released
+    using ActionHandler = std::function<void(bool pressed)>;
+    using ClickHandler = std::function<void(Vector2 position)>;
+
 private:
-    std::map<std::string, Mix_Music *> music;
-    std::map<std::string, Mix_Chunk *> sounds;
+    static const int MOUSE_BUTTON_COUNT = 8;
+
+    template <typename Handler>
+    struct Subscription {
+        int id;
+        Handler handler;
+    };
+
+    // Edges store the tick they happened on, so starting a tick is a single increment
+    Uint32 tick = 1;
+
+    bool keysHeld[SDL_NUM_SCANCODES];
+    Uint32 keysPressed[SDL_NUM_SCANCODES];
+    Uint32 keysReleased[SDL_NUM_SCANCODES];
+
+    bool mouseHeld[MOUSE_BUTTON_COUNT];
+    Uint32 mousePressed[MOUSE_BUTTON_COUNT];
+    Uint32 mouseReleased[MOUSE_BUTTON_COUNT];
+
+    Vector2 mousePosition;
+    // Where the last button press of the tick happened
+    Vector2 mousePressPosition;
+
+    SDL_Scancode bindings[PLAYER_COUNT][ACTION_COUNT];
+
+    // Handlers must not subscribe or unsubscribe while being dispatched
+    std::vector<Subscription<ActionHandler>> actionSubscribers[PLAYER_COUNT][ACTION_COUNT];
+    std::vector<Subscription<ClickHandler>> clickSubscribers;
+    int nextSubscriptionId = 1;
+
+    void SetDefaultBindings();
+    void DispatchKey(SDL_Scancode scancode, bool pressed);
+    void DispatchAction(int player, InputAction action, bool pressed);
+
+    InputManager();
+    static InputManager *instance;
+
+public:
+    static InputManager *GetInstance();
+
+    // Starts a new tick, call before feeding the tick's events
+    void BeginTick();
+    void ProcessEvent(const SDL_Event &event);
+
+    // Held this tick
+    bool GetKey(SDL_Keycode key);
+    // Went down this tick, key repeats don't count
+    bool GetKeyDown(SDL_Keycode key);
+    // Went up this tick
+    bool GetKeyUp(SDL_Keycode key);
+
+    bool GetMouseButton(int button);
+    bool GetMouseButtonDown(int button);
+    bool GetMouseButtonUp(int button);
+
+    Vector2 GetMousePosition();
+    Vector2 GetMousePressPosition();
+
+    // Actions
+    // Returns an id for Unsubscribe
+    int Subscribe(int player, InputAction action, ActionHandler handler);
+    // Left button presses
+    int SubscribeClick(ClickHandler handler);
+    void Unsubscribe(int id);
+
+    // Whether the key bound to the action is held
+    bool GetAction(int player, InputAction action);
+
+    // Releases the old key first if it is held, so nothing gets stuck
+    void Bind(int player, InputAction action, SDL_Scancode scancode);
+    SDL_Scancode GetBinding(int player, InputAction action);
+
+    /*Reads "<scope> <Action> = <Key Name>" lines, scope is player1, player2 or global.
+    Key names are SDL scancode names ("W", "Space", "Keypad Enter"). Unlisted actions keep their binding.
+    Returns false if the file could not be opened.
+    */
+    bool LoadBindings(const std::string &path);
+
+    static const char *GetActionName(InputAction action);
+};
 
+// Handle of a sound, see SoundManager::GetSoundId
+typedef int SoundId;
+const SoundId INVALID_SOUND = -1;
+
+/*Music and sound effects, both decoded up front by the AudioCache so the mixer only copies samples.
+Music plays on a channel of its own after the voices (MUSIC_CHANNEL), not streamed through Mix_PlayMusic.
+Sounds are played through a fixed pool of VOICE_COUNT mixer channels, each with its own volume.
+When every voice is busy a new sound takes over the voice of the lowest priority sound that is not
+above its own, the oldest one among equals, and is dropped if there is none.
+Hot paths resolve a SoundId once and play by id, playing by name costs a map lookup.
+PlaySound only queues a request, Flush starts the queued sounds once per frame. Requests for a sound
+already queued this frame, or started less than its coalesce window ago, are merged into that one,
+and a sound never plays more than its instance limit at once. Collisions fire every overlapping frame,
+without this the same sample would restart dozens of times a second.
+Sounds played at a position are panned and attenuated towards the sides of the field. The play calls of a
+frame only add up x, Flush looks the averaged position up in a table of PAN_STEPS channel gains built once.
+*/
+class SoundManager {
+public:
+    static const int VOICE_COUNT = 16;
+    static const Uint32 DEFAULT_COALESCE_WINDOW_MS = 50;
+    static const int DEFAULT_MAX_INSTANCES = 3;
+    static const int MUSIC_CHANNEL = VOICE_COUNT;
+    static const int PAN_STEPS = 128;
+
+private:
+    struct Sound {
+        std::string name;
+        Mix_Chunk *chunk = nullptr; // nullptr until loaded
+        int volume = MIX_MAX_VOLUME;
+        int priority = 0;
+
+        Uint32 coalesceWindow = DEFAULT_COALESCE_WINDOW_MS;
+        int maxInstances = DEFAULT_MAX_INSTANCES;
+        Uint32 lastStartTime = 0;
+        int request = -1; // Index of this frame's request, -1 if not queued
+    };
+
+    struct Request {
+        SoundId sound;
+        int loops;
+        // Positions it was played at this frame, centred if none
+        float positionSum = 0;
+        int positionCount = 0;
+    };
+
+    // Mix_SetPanning volumes
+    struct Pan {
+        Uint8 left, right;
+    };
+
+    // What was last started on a channel
+    struct Voice {
+        SoundId sound = INVALID_SOUND;
+        int priority = 0;
+        Uint32 startTime = 0;
+    };
+
+    std::map<std::string, Mix_Chunk *> music;
     std::map<std::string, int> musicVolumes;
-    std::map<std::string, int> soundVolumes;
+
+    // Indexed by SoundId, ids stay valid for the whole run
+    std::vector<Sound> sounds;
+    std::map<std::string, SoundId> soundIds;
+
+    Voice voices[VOICE_COUNT];
+
+    // Requests of the current frame, at most one per sound
+    std::vector<Request> requests;
 
     std::string currentMusic;
 
+    // Across the field from left to right
+    Pan panTable[PAN_STEPS];
+    float fieldWidth;
+
+    void BuildPanTable();
+    Request *Queue(SoundId id, int loops);
+
+    // Starts a sound on a voice right away, panStep -1 plays it centred
+    void Start(SoundId id, int loops, int panStep);
+    int CountInstances(SoundId id);
+
+    // Channel to play a sound of this priority on, -1 if every voice is taken by something more important
+    int AllocateVoice(int priority);
+
     SoundManager();
     static SoundManager *instance;
 public:
@@ -309,10 +599,25 @@ public:
     static SoundManager *GetInstance();
 
     void AddMusic(std::string name, std::string path, int volume);
-    void AddSound(std::string name, std::string path, int volume);
+    // Higher priority sounds may take the voices of lower ones
+    void AddSound(std::string name, std::string path, int volume = MIX_MAX_VOLUME, int priority = 0);
+    // Takes ownership of already loaded audio, e.g. from the AssetLoader. Replaces an entry with the same name.
+    void AddMusic(std::string name, Mix_Chunk *music, int volume);
+    void AddSound(std::string name, Mix_Chunk *sound, int volume, int priority = 0);
+
+    // Id of the named sound, it doesn't need to be loaded yet. Playing it does nothing until it is.
+    SoundId GetSoundId(const std::string &name);
+    // windowMs 0 only merges requests of the same frame
+    void SetSoundLimits(SoundId sound, Uint32 coalesceWindowMs, int maxInstances);
 
     void PlayMusic(std::string name, int loops = -1);
-    void PlaySound(std::string name, int loops = 0);
+    // Queued until the next Flush
+    void PlaySound(SoundId sound, int loops = 0);
+    // Panned by the x of position on the field
+    void PlaySound(SoundId sound, Vector2 position, int loops = 0);
+    void PlaySound(const std::string &name, int loops = 0);
+    // Starts the queued sounds, called once at the end of every frame
+    void Flush();
 
     void StopMusic();
     void StopSound();
@@ -0,0 +1,81 @@
+#include "FramePacer.hpp"
+
+#include <cmath>
+#include <iostream>
+
+FramePacer::FramePacer(int fps, bool vsync) {
+    this->frequency = (double)SDL_GetPerformanceFrequency();
+    this->period = (Uint64)(frequency / fps);
+    this->vsync = vsync;
+}
+
+void FramePacer::Wait() {
+    Uint64 now = SDL_GetPerformanceCounter();
+
+    if (vsync) {
+        RecordInterval(now);
+        return;
+    }
+
+    if (deadline == 0) {
+        deadline = now + period;
+    }
+
+    if (now < deadline) {
+        double remainingMs = (deadline - now) * 1000.0 / frequency;
+        if (remainingMs > SPIN_MARGIN_MS) {
+            SDL_Delay((Uint32)(remainingMs - SPIN_MARGIN_MS));
+        }
+        while ((now = SDL_GetPerformanceCounter()) < deadline) {
+        }
+    }
+
+    RecordInterval(now);
+
+    // Fixed steps keep the average rate exact, but a frame that overran by more than a period
+    // (scene loads, window drags) starts a new schedule instead of rushing the following frames
+    deadline += period;
+    if (now > deadline) {
+        deadline = now + period;
+    }
+}
+
+void FramePacer::RecordInterval(Uint64 now) {
+    if (lastFrameEnd != 0) {
+        double intervalMs = (now - lastFrameEnd) * 1000.0 / frequency;
+        double jitter = std::fabs(intervalMs - period * 1000.0 / frequency);
+
+        intervalSum += intervalMs;
+        jitterSum += jitter;
+        jitterSquareSum += jitter * jitter;
+        if (jitter > jitterMax)
+            jitterMax = jitter;
+        if (now - lastFrameEnd > period + period / 2)
+            missedFrames++;
+        frameCount++;
+    }
+    lastFrameEnd = now;
+}
+
+void FramePacer::Reset() {
+    deadline = 0;
+    lastFrameEnd = 0;
+}
+
+void FramePacer::SetVSync(bool vsync) {
+    this->vsync = vsync;
+    Reset();
+}
+
+void FramePacer::Report() {
+    if (frameCount == 0)
+        return;
+
+    double meanJitter = jitterSum / frameCount;
+    double rmsJitter = std::sqrt(jitterSquareSum / frameCount);
+
+    std::cout << "Frame pacing" << (vsync ? " (vsync)" : "") << ": " << frameCount << " frames, target "
+              << period * 1000.0 / frequency << " ms, mean interval " << intervalSum / frameCount << " ms, jitter mean "
+              << meanJitter << " ms, rms " << rmsJitter << " ms, max " << jitterMax << " ms, "
+              << missedFrames << " missed" << std::endl;
+}
@@ -0,0 +1,47 @@
+#ifndef FRAMEPACER_HPP
+#define FRAMEPACER_HPP
+
+#include <SDL2/SDL.h>
+
+/*Holds the main loop to a fixed frame rate.
+Frames are scheduled on absolute deadlines measured with the performance counter, so the work time
+is part of the frame instead of being added on top of a fixed sleep.
+Wait sleeps with SDL_Delay for most of the remainder and spins for the last SPIN_MARGIN_MS,
+SDL_Delay only has millisecond granularity and may oversleep.
+With VSync the present call already blocks, Wait then only records the statistics.
+*/
+class FramePacer {
+private:
+    // Sleeping closer than this to the deadline risks waking up late
+    static constexpr double SPIN_MARGIN_MS = 2.0;
+
+    double frequency;
+    Uint64 period;
+    Uint64 deadline = 0;
+    bool vsync;
+
+    // Jitter statistics, the deviation of each frame interval from the period
+    Uint64 lastFrameEnd = 0;
+    Uint64 frameCount = 0;
+    Uint64 missedFrames = 0;
+    double jitterSum = 0, jitterSquareSum = 0, jitterMax = 0;
+    double intervalSum = 0;
+
+    void RecordInterval(Uint64 now);
+
+public:
+    FramePacer(int fps, bool vsync);
+
+    // Blocks until the current frame's deadline, call once at the end of every frame
+    void Wait();
+
+    // Forgets the schedule, e.g. after reinitialising the game, so the next frames don't try to catch up
+    void Reset();
+
+    void SetVSync(bool vsync);
+
+    // Prints the achieved frame interval and the jitter
+    void Report();
+};
+
+#endif // FRAMEPACER_HPP
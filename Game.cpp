@@ -1,16 +1,31 @@
 #include "Game.hpp"
+#include "AssetArchive.hpp"
+#include "AssetLoader.hpp"
 #include "Components.hpp"
 #include "CustomClasses.hpp"
 #include "Global.hpp"
 #include "Helper.hpp"
 #include "Physic2D.hpp"
+#include "Profiler.hpp"
 #include "SDLCustomEvent.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
 #include <iostream>
+#include <random>
+#include <SDL2/SDL_image.h>
 #include <SDL2/SDL_mixer.h>
 
-SDL_Event Game::event;
+float Game::frameTime = 0;
+bool Game::simulatedTime = false;
+int Game::aiThreadCount = ThreadPool::AUTO_THREAD_COUNT;
+
+Uint32 Game::GetTime() {
+    if (simulatedTime)
+        return (Uint32)(GameObjectManager::GetInstance()->GetUpdateCount() * 1000 / FPS);
+    return SDL_GetTicks();
+}
 
 Game::Game() {
     isRunning = false;
@@ -23,9 +38,19 @@ void Game::init(const char *title, int xpos, int ypos, int width, int height, bo
     reset = false;
     int flags = 0;
     
-    if (fullscreen) {
+    if (fullscreen && !headless) {
         flags = SDL_WINDOW_FULLSCREEN;
     }
+    if (headless) {
+        flags |= SDL_WINDOW_HIDDEN;
+    }
+
+    // Self-play runs many matches side by side, none of them should be heard
+    if (selfPlayMode) {
+        SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+        selfPlayRng.seed(selfPlayConfig.seed);
+    }
+    simulatedTime = selfPlayMode;
 
     if (SDL_Init(SDL_INIT_EVERYTHING) == 0) {
         std::cout << "Subsystems Initialised..." << std::endl;
@@ -35,8 +60,11 @@ void Game::init(const char *title, int xpos, int ypos, int width, int height, bo
             std::cout << "Window created..." << std::endl;
         }
 
-        renderer = SDL_CreateRenderer(window, -1, 0);
+        bool requestVSync = VSYNC && !headless;
+        renderer = SDL_CreateRenderer(window, -1, requestVSync ? SDL_RENDERER_PRESENTVSYNC : 0);
         if (renderer) {
+            SDL_RendererInfo info;
+            vsync = requestVSync && SDL_GetRendererInfo(renderer, &info) == 0 && (info.flags & SDL_RENDERER_PRESENTVSYNC);
             SDL_SetRenderDrawColor(renderer, 128, 239, 129, 255);
             std::cout << "Renderer created..." << std::endl;
         }
@@ -56,34 +84,101 @@ void Game::init(const char *title, int xpos, int ypos, int width, int height, bo
             return;
         }
 
+        // Up front on the main thread, the loader's workers decode images concurrently
+        if ((IMG_Init(IMG_INIT_JPG | IMG_INIT_PNG) & (IMG_INIT_JPG | IMG_INIT_PNG)) == 0) {
+            std::cerr << "Failed to initialize SDL_image: " << IMG_GetError() << std::endl;
+        }
+
         isRunning = true;
     } else {
         isRunning = false;
     }
 
-    state = MENU;
+    InputManager::GetInstance()->LoadBindings(INPUT_BINDINGS_PATH);
+    subscribeHotkeys();
+
+    // Stays mapped across resets, reloads read from it again
+    AssetArchive::GetInstance()->Open(ASSET_ARCHIVE_PATH);
+
+    state = stressMode ? STRESS : LOADING;
     objectInit();
 }
 
+void Game::subscribeHotkeys() {
+    InputManager *input = InputManager::GetInstance();
+
+    inputSubscriptions.push_back(input->Subscribe(0, ACTION_MENU, [this](bool pressed) {
+        if (!pressed || state == LOADING)
+            return;
+        state = MENU;
+        scoreTeam1 = scoreTeam2 = 0;
+    }));
+    inputSubscriptions.push_back(input->Subscribe(0, ACTION_DUMP_TRACE, [](bool pressed) {
+        if (pressed)
+            TraceRecorder::GetInstance()->DumpNext();
+    }));
+    inputSubscriptions.push_back(input->Subscribe(0, ACTION_DUMP_COUNTERS, [](bool pressed) {
+        if (pressed)
+            Counters::DumpCsv("counters.csv");
+    }));
+    inputSubscriptions.push_back(input->Subscribe(0, ACTION_TOGGLE_COUNTERS, [this](bool pressed) {
+        if (!pressed)
+            return;
+        showCounters = !showCounters;
+        counterRefreshFrame = 0;
+    }));
+    inputSubscriptions.push_back(input->Subscribe(0, ACTION_RELOAD_BINDINGS, [](bool pressed) {
+        if (pressed)
+            InputManager::GetInstance()->LoadBindings(INPUT_BINDINGS_PATH);
+    }));
+}
+
 GameObject *player = new GameObject("Player");
 
 void Game::objectInit() {
-    
-    //Add sounds and music
-    SoundManager::GetInstance();
-    SoundManager::GetInstance()->AddMusic("MenuBgm", "Assets/SFX/fairyfountain.mp3", 100);
-    SoundManager::GetInstance()->AddMusic("GameBgm", "Assets/SFX/papyrus.mp3", 32);
+    PROFILE_ZONE("Game::objectInit");
 
-    SoundManager::GetInstance()->AddSound("ball_bounce", "Assets/SFX/ball_bounce.mp3", 128);
-    SoundManager::GetInstance()->AddSound("ball_kick", "Assets/SFX/ball_kick.mp3", 128);
+    // Opens the audio device, the loader decodes sounds into its format
+    SoundManager::GetInstance();
+    queueAssets();
 
-    SoundManager::GetInstance()->AddSound("Game_Over", "Assets/SFX/gameover.mp3", 128);
-    SoundManager::GetInstance()->AddSound("Goal", "Assets/SFX/score.mp3", 64);
+    // Measurements shouldn't include loading in the background. Self-play waits too, the AI schedules its
+    // decisions by update count, so a loading screen of varying length would change how a match plays.
+    if (state == STRESS || selfPlayMode)
+        AssetLoader::GetInstance()->Finish();
 
     std::cout << "Object Initialisation..." << std::endl;
 
+    Scene *loadingScene = new Scene("Loading");
+    loadingScene->AssignLogic([loadingScene, this]() {
+        PROFILE_ZONE("Scene.Loading");
+        Game::state = LOADING;
+
+        // Loaded synchronously, the screen has to show up before anything else is ready
+        GameObject *kirby = new GameObject("LoadingKirby");
+        kirby->transform.position = Vector2(640, 320);
+        kirby->transform.scale = Vector2(3, 3);
+        kirby->AddComponent(new SpriteRenderer(kirby, Vector2(35, 37), 0, LoadSpriteSheet("Assets/kirby_float.png")));
+        kirby->AddComponent(new Animator(kirby, {AnimationClip("Float", "Assets/kirby_float.png", Vector2(35, 37), 500, true, 1.0, 0, 4)}));
+        kirby->GetComponent<Animator>()->Play("Float");
+
+        GameObjectManager::GetInstance()->AddGameObject(kirby);
+
+        GameObject *progressBar = new GameObject("LoadingBar");
+        progressBar->transform.position = Vector2(640, 460);
+        progressBar->AddComponent(new ProgressBar(progressBar, Vector2(400, 24), []() {
+            return AssetLoader::GetInstance()->GetProgress();
+        }));
+
+        GameObjectManager::GetInstance()->AddGameObject(progressBar);
+    });
+
+    SceneManager::GetInstance()->AddScene(loadingScene);
+
     Scene *menuScene = new Scene("MainMenu");
+    menuScene->SetStatic(true);
     menuScene->AssignLogic([menuScene, this]() {
+        PROFILE_ZONE("Scene.MainMenu");
         Game::state = MENU;
         SoundManager::GetInstance()->PlayMusic("MenuBgm");
 
@@ -91,7 +186,10 @@ void Game::objectInit() {
         background->transform.position = Vector2(640, 360);
         background->transform.scale = Vector2(1, 1);
 
-        background->AddComponent(new SpriteRenderer(background, Vector2(2560, 1707), -10, LoadSpriteSheet("Assets/Sprites/UI/MenuBG.jpg")));
+        // MenuBG.jpg is 2560x1707 drawn unscaled around the centre, only the middle of it is ever on screen
+        SDL_Rect visibleBackground = {(2560 - WIDTH) / 2, (1707 - HEIGHT) / 2, WIDTH, HEIGHT};
+        background->AddComponent(new SpriteRenderer(background, Vector2(WIDTH, HEIGHT), -10,
+            LoadSpriteSheetScaled("Assets/Sprites/UI/MenuBG.jpg", WIDTH, HEIGHT, &visibleBackground)));
 
         GameObjectManager::GetInstance()->AddGameObject(background);
 
@@ -194,8 +292,10 @@ void Game::objectInit() {
     SceneManager::GetInstance()->AddScene(menuScene);
 
     Scene *gameoverScene = new Scene("GameOver");
+    gameoverScene->SetStatic(true);
 
     gameoverScene->AssignLogic([gameoverScene, this]() {
+        PROFILE_ZONE("Scene.GameOver");
         SoundManager::GetInstance()->StopMusic();
         SoundManager::GetInstance()->PlaySound("Game_Over");
 
@@ -233,8 +333,10 @@ void Game::objectInit() {
 
     Scene *gameScene = new Scene("Game");
     gameScene->AssignLogic([gameScene, this]() {
+        PROFILE_ZONE("Scene.Game");
         Game::state = GAME;
-        SoundManager::GetInstance()->PlayMusic("GameBgm");
+        if (!selfPlayMode)
+            SoundManager::GetInstance()->PlayMusic("GameBgm");
 
 #pragma region Background Setup
         GameObject *background = new GameObject("Background");
@@ -259,6 +361,13 @@ void Game::objectInit() {
 
         ball->AddComponent(new Rigidbody2D(ball, 1, 0.025, .9));
 
+        // Otherwise every self-play match with the same parameters plays out the same
+        if (selfPlayMode) {
+            std::uniform_real_distribution<float> angle(0, 2 * M_PI), strength(0, 3);
+            float a = angle(selfPlayRng);
+            ball->GetComponent<Rigidbody2D>()->velocity = Vector2(std::cos(a), std::sin(a)) * strength(selfPlayRng);
+        }
+
         ball->AddComponent(new VelocityToAnimSpeedController(ball, "Roll"));
         ball->AddComponent(new StayInBounds(ball, false));
 
@@ -306,12 +415,18 @@ void Game::objectInit() {
         player5->AddComponent(new Animator(player5, {AnimationClip("Run", "Assets/Sprites/football5.png", Vector2(32, 32), 1000, true, 1.0, 0, 5)}));
         player6->AddComponent(new Animator(player6, {AnimationClip("Run", "Assets/Sprites/football6.png", Vector2(32, 32), 1000, true, 1.0, 0, 5)}));
 
-        auto setupCollisionHandler = [](GameObject *player) {
+        // Players turn toward their velocity, pre-render their run cycles when rotation is cached
+        for (GameObject *player : {player1, player2, player3, player4, player5, player6}) {
+            RotatedSpriteCache::GetInstance()->Prepare(player);
+        }
+
+        SoundId bounceSound = SoundManager::GetInstance()->GetSoundId("ball_bounce");
+        auto setupCollisionHandler = [bounceSound](GameObject *player) {
             player->GetComponent<CircleCollider2D>()->OnCollisionEnter.addHandler(
-                [player](Collider2D *collider) {
+                [player, bounceSound](Collider2D *collider) {
                     if (collider->gameObject->tag == 4) {
                         Rigidbody2D *rigidbody = player->GetComponent<Rigidbody2D>();
-                        SoundManager::GetInstance()->PlaySound("ball_bounce");
+                        SoundManager::GetInstance()->PlaySound(bounceSound, player->transform.position);
                         rigidbody->BounceOff(collider->GetNormal(player->transform.position));
                     }
                 });
@@ -324,51 +439,56 @@ void Game::objectInit() {
         setupCollisionHandler(player5);
         setupCollisionHandler(player6);
 
-        player1->AddComponent(new MovementController(player1, GoalKeeperSpeed, true));
-        player2->AddComponent(new MovementController(player2, DefenderSpeed, true));
-        player3->AddComponent(new MovementController(player3, AttackerSpeed, true));
+        // Without a movement controller the AI plays both teams
+        if (!selfPlayMode) {
+            player1->AddComponent(new MovementController(player1, GoalKeeperSpeed, 0));
+            player2->AddComponent(new MovementController(player2, DefenderSpeed, 0));
+            player3->AddComponent(new MovementController(player3, AttackerSpeed, 0));
+        }
 
         if (Player2Mode) {
-            player4->AddComponent(new MovementController(player4, AttackerSpeed, false));
-            player5->AddComponent(new MovementController(player5, DefenderSpeed, false));
-            player6->AddComponent(new MovementController(player6, GoalKeeperSpeed, false));
+            player4->AddComponent(new MovementController(player4, AttackerSpeed, 1));
+            player5->AddComponent(new MovementController(player5, DefenderSpeed, 1));
+            player6->AddComponent(new MovementController(player6, GoalKeeperSpeed, 1));
         }
 
-        player1->AddComponent(new KickControl(player1, ball, SDLK_SPACE, HIGH_KICK_FORCE));
-        player2->AddComponent(new KickControl(player2, ball, SDLK_SPACE, LOW_KICK_FORCE));
-        player3->AddComponent(new KickControl(player3, ball, SDLK_SPACE, HIGH_KICK_FORCE));
+        player1->AddComponent(new KickControl(player1, ball, 0, HIGH_KICK_FORCE));
+        player2->AddComponent(new KickControl(player2, ball, 0, LOW_KICK_FORCE));
+        player3->AddComponent(new KickControl(player3, ball, 0, HIGH_KICK_FORCE));
 
         if (Player2Mode) {
-            player4->AddComponent(new KickControl(player4, ball, SDLK_KP_ENTER, HIGH_KICK_FORCE));
-            player5->AddComponent(new KickControl(player5, ball, SDLK_KP_ENTER, LOW_KICK_FORCE));
-            player6->AddComponent(new KickControl(player6, ball, SDLK_KP_ENTER, HIGH_KICK_FORCE));
+            player4->AddComponent(new KickControl(player4, ball, 1, HIGH_KICK_FORCE));
+            player5->AddComponent(new KickControl(player5, ball, 1, LOW_KICK_FORCE));
+            player6->AddComponent(new KickControl(player6, ball, 1, HIGH_KICK_FORCE));
         }
 
-        player1->AddComponent(new AIGoalKeeper(player1, ball, GoalKeeperSpeed, true));
-        player2->AddComponent(new AIDefender(player2, ball, DefenderSpeed, true));
-        player3->AddComponent(new AIAttacker(player3, ball, AttackerSpeed, true));
+        player1->AddComponent(new AIGoalKeeper(player1, ball, aiParams[0], true));
+        player2->AddComponent(new AIDefender(player2, ball, aiParams[0], true));
+        player3->AddComponent(new AIAttacker(player3, ball, aiParams[0], true));
 
-        player4->AddComponent(new AIAttacker(player4, ball, AttackerSpeed, false));
-        player5->AddComponent(new AIDefender(player5, ball, DefenderSpeed, false));
-        player6->AddComponent(new AIGoalKeeper(player6, ball, GoalKeeperSpeed, false));
+        player4->AddComponent(new AIAttacker(player4, ball, aiParams[1], false));
+        player5->AddComponent(new AIDefender(player5, ball, aiParams[1], false));
+        player6->AddComponent(new AIGoalKeeper(player6, ball, aiParams[1], false));
 
         // First controller switcher for player1, player2, and player3
-        GameObject *controllerSwitcher1 = new GameObject("ControllerSwitcher1");
-        TeamControl *movementControllerSwitcher1 = dynamic_cast<TeamControl *>(controllerSwitcher1->AddComponent(
-            new TeamControl(controllerSwitcher1, LoadSpriteSheet("Assets/blue_indicator.png"), 75.0)));
-        movementControllerSwitcher1->AddMovementController(SDLK_1, player1->GetComponent<MovementController>());
-        movementControllerSwitcher1->AddMovementController(SDLK_2, player2->GetComponent<MovementController>());
-        movementControllerSwitcher1->AddMovementController(SDLK_3, player3->GetComponent<MovementController>());
-        GameObjectManager::GetInstance()->AddGameObject(controllerSwitcher1);
+        if (!selfPlayMode) {
+            GameObject *controllerSwitcher1 = new GameObject("ControllerSwitcher1");
+            TeamControl *movementControllerSwitcher1 = dynamic_cast<TeamControl *>(controllerSwitcher1->AddComponent(
+                new TeamControl(controllerSwitcher1, LoadSpriteSheet("Assets/blue_indicator.png"), 75.0, 0)));
+            movementControllerSwitcher1->AddMovementController(ACTION_SWITCH_PLAYER_1, player1->GetComponent<MovementController>());
+            movementControllerSwitcher1->AddMovementController(ACTION_SWITCH_PLAYER_2, player2->GetComponent<MovementController>());
+            movementControllerSwitcher1->AddMovementController(ACTION_SWITCH_PLAYER_3, player3->GetComponent<MovementController>());
+            GameObjectManager::GetInstance()->AddGameObject(controllerSwitcher1);
+        }
 
         if (Player2Mode || TestMode) {
             // Second controller switcher for player4, player5, and player6
             GameObject *controllerSwitcher2 = new GameObject("ControllerSwitcher2");
             TeamControl *movementControllerSwitcher2 = dynamic_cast<TeamControl *>(controllerSwitcher2->AddComponent(
-                new TeamControl(controllerSwitcher2, LoadSpriteSheet("Assets/red_indicator.png"), 75.0)));
-            movementControllerSwitcher2->AddMovementController(SDLK_KP_6, player6->GetComponent<MovementController>());
-            movementControllerSwitcher2->AddMovementController(SDLK_KP_4, player4->GetComponent<MovementController>());
-            movementControllerSwitcher2->AddMovementController(SDLK_KP_5, player5->GetComponent<MovementController>());
+                new TeamControl(controllerSwitcher2, LoadSpriteSheet("Assets/red_indicator.png"), 75.0, 1)));
+            movementControllerSwitcher2->AddMovementController(ACTION_SWITCH_PLAYER_1, player6->GetComponent<MovementController>());
+            movementControllerSwitcher2->AddMovementController(ACTION_SWITCH_PLAYER_2, player4->GetComponent<MovementController>());
+            movementControllerSwitcher2->AddMovementController(ACTION_SWITCH_PLAYER_3, player5->GetComponent<MovementController>());
             GameObjectManager::GetInstance()->AddGameObject(controllerSwitcher2);
         }
 
@@ -393,6 +513,8 @@ void Game::objectInit() {
 #pragma endregion
 
 #pragma region Goal Setup
+        SoundId goalSound = SoundManager::GetInstance()->GetSoundId("Goal");
+
         GameObject *goal1 = new GameObject("Goal1");
         goal1->transform.position = Vector2(30, 360);
         goal1->transform.scale = Vector2(5, 4);
@@ -404,12 +526,12 @@ void Game::objectInit() {
         ));
 
         goal1->GetComponent<BoxCollider2D>()->OnCollisionEnter.addHandler(
-            [goal1, this](Collider2D *collider) {
+            [goal1, goalSound, this](Collider2D *collider) {
                 BoxCollider2D *goal1Col = goal1->GetComponent<BoxCollider2D>();
                 if (collider->gameObject->tag == 3) {
                     if (goal1Col->GetNormal(collider->gameObject->transform.position) == Vector2(1, 0)) {
                         std::cout << "Goal!!! Right team scored!" << std::endl;
-                        SoundManager::GetInstance()->PlaySound("Goal");
+                        SoundManager::GetInstance()->PlaySound(goalSound, collider->gameObject->transform.position);
                         this->scoreTeam2++;
                         SceneManager::GetInstance()->LoadScene("Game");
                     } else {
@@ -436,12 +558,12 @@ void Game::objectInit() {
         ));
 
         goal2->GetComponent<BoxCollider2D>()->OnCollisionEnter.addHandler(
-            [goal2, this](Collider2D *collider) {
+            [goal2, goalSound, this](Collider2D *collider) {
                 BoxCollider2D *goal2Col = goal2->GetComponent<BoxCollider2D>();
                 if (collider->gameObject->tag == 3) {
                     if (goal2Col->GetNormal(collider->gameObject->transform.position) == Vector2(-1, 0)) {
                         std::cout << "Goal!!! Left team scored!" << std::endl;
-                        SoundManager::GetInstance()->PlaySound("Goal");
+                        SoundManager::GetInstance()->PlaySound(goalSound, collider->gameObject->transform.position);
                         this->scoreTeam1++;
                         SceneManager::GetInstance()->LoadScene("Game");
                         return;
@@ -457,28 +579,216 @@ void Game::objectInit() {
 
         GameObjectManager::GetInstance()->AddGameObject(goal2);
 
+        // Goals scored through the side facing the field
+        AIBlackboard::GetInstance()->SetGoal(1, goal1, -1);
+        AIBlackboard::GetInstance()->SetGoal(2, goal2, 1);
+
 #pragma endregion
     });
 
     SceneManager::GetInstance()->AddScene(gameScene);
-    SceneManager::GetInstance()->LoadScene("MainMenu");
+
+    Scene *stressScene = new Scene("Stress");
+    stressScene->AssignLogic([stressScene, this]() {
+        PROFILE_ZONE("Scene.Stress");
+        Game::state = STRESS;
+
+        std::mt19937 rng(stressConfig.seed + stressStep);
+        std::uniform_real_distribution<float> randomX(0, WIDTH), randomY(0, HEIGHT), randomUnit(-1, 1);
+
+        int scale = 1 << stressStep;
+        int players = stressConfig.players * scale;
+        int balls = stressConfig.balls * scale;
+        int walls = stressConfig.walls * scale;
+        int decorations = stressConfig.decorations * scale;
+
+        GameObject *background = new GameObject("Background");
+        background->transform.position = Vector2(640, 360);
+        background->AddComponent(new SpriteRenderer(background, Vector2(1280, 720), -10, LoadSpriteSheet("Assets/Sprites/yard.png")));
+        GameObjectManager::GetInstance()->AddGameObject(background);
+
+        SDL_Texture *actorTexture = LoadSpriteSheet("Assets/actor.png");
+        SDL_Texture *wallTexture = LoadSpriteSheet("Assets/wall.png");
+        SDL_Texture *defaultTexture = LoadSpriteSheet("Assets/default.png");
+
+        // Templates, instantiated below so the clips share their sprite sheets
+        GameObject *playerTemplate = new GameObject("PlayerTemplate");
+        playerTemplate->transform.scale = Vector2(2, 2);
+        playerTemplate->AddComponent(new SpriteRenderer(playerTemplate, Vector2(31, 82), 0, actorTexture));
+        playerTemplate->AddComponent(new Rigidbody2D(playerTemplate, 1, 0.04, .2));
+        playerTemplate->AddComponent(new CircleCollider2D(playerTemplate, Vector2(0, 0), 17 * playerTemplate->transform.scale.x));
+        playerTemplate->AddComponent(new StayInBounds(playerTemplate, false));
+        playerTemplate->AddComponent(new RotateTowardVelocity(playerTemplate, Vector2(0, -1)));
+        playerTemplate->AddComponent(new VelocityToAnimSpeedController(playerTemplate, "Run"));
+        playerTemplate->AddComponent(new Animator(playerTemplate, {AnimationClip("Run", "Assets/Sprites/football.png", Vector2(32, 32), 1000, true, 1.0, 0, 5)}));
+        RotatedSpriteCache::GetInstance()->Prepare(playerTemplate);
+        playerTemplate->AddComponent(new RandomImpulse(playerTemplate, 5.0f, FPS));
+        CollisionManager::GetInstance()->RemoveCollider(playerTemplate->GetComponent<Collider2D>());
+
+        GameObject *ballTemplate = new GameObject("BallTemplate");
+        ballTemplate->transform.scale = Vector2(2, 2);
+        ballTemplate->AddComponent(new SpriteRenderer(ballTemplate, Vector2(15, 15), 10, defaultTexture));
+        ballTemplate->AddComponent(new Animator(ballTemplate, {AnimationClip("Roll", "Assets/soccer_ball.png", Vector2(15, 15), 1000, true, 1.0, 0, 1)}));
+        ballTemplate->AddComponent(new Rigidbody2D(ballTemplate, 1, 0.025, .9));
+        ballTemplate->AddComponent(new VelocityToAnimSpeedController(ballTemplate, "Roll"));
+        ballTemplate->AddComponent(new StayInBounds(ballTemplate, false));
+        ballTemplate->AddComponent(new CircleCollider2D(ballTemplate, Vector2(0, 0), 7.5));
+        ballTemplate->AddComponent(new BallStateMachine(ballTemplate, 2.0, 700, 1000));
+        ballTemplate->AddComponent(new RandomImpulse(ballTemplate, 15.0f, 3 * FPS));
+        CollisionManager::GetInstance()->RemoveCollider(ballTemplate->GetComponent<Collider2D>());
+
+        GameObject *decorationTemplate = new GameObject("DecorationTemplate");
+        decorationTemplate->transform.scale = Vector2(1, 1);
+        decorationTemplate->AddComponent(new SpriteRenderer(decorationTemplate, Vector2(35, 37), -5, defaultTexture));
+        decorationTemplate->AddComponent(new Animator(decorationTemplate, {AnimationClip("Float", "Assets/kirby_float.png", Vector2(35, 37), 500, true, 1.0, 0, 4)}));
+
+        SoundId bounceSound = SoundManager::GetInstance()->GetSoundId("ball_bounce");
+        for (int i = 0; i < players; i++) {
+            GameObject *player = GameObject::Instantiate("StressPlayer" + std::to_string(i), playerTemplate, Vector2(randomX(rng), randomY(rng)), 0, Vector2(2, 2));
+            player->tag = i % 2 + 1;
+            player->GetComponent<Animator>()->Play("Run");
+            player->GetComponent<Rigidbody2D>()->velocity = Vector2(randomUnit(rng), randomUnit(rng)) * 5;
+            player->GetComponent<RandomImpulse>()->Seed(stressConfig.seed + stressStep, i);
+
+            player->GetComponent<CircleCollider2D>()->OnCollisionEnter.addHandler(
+                [player, bounceSound](Collider2D *collider) {
+                    if (collider->gameObject->tag == 4) {
+                        Rigidbody2D *rigidbody = player->GetComponent<Rigidbody2D>();
+                        SoundManager::GetInstance()->PlaySound(bounceSound, player->transform.position);
+                        rigidbody->BounceOff(collider->GetNormal(player->transform.position));
+                    }
+                });
+
+            GameObjectManager::GetInstance()->AddGameObject(player);
+        }
+
+        for (int i = 0; i < balls; i++) {
+            GameObject *ball = GameObject::Instantiate("StressBall" + std::to_string(i), ballTemplate, Vector2(randomX(rng), randomY(rng)), 0, Vector2(2, 2));
+            ball->tag = 3;
+            ball->GetComponent<Animator>()->Play("Roll");
+            ball->GetComponent<Rigidbody2D>()->velocity = Vector2(randomUnit(rng), randomUnit(rng)) * 10;
+            ball->GetComponent<RandomImpulse>()->Seed(stressConfig.seed + stressStep, players + i);
+
+            ball->GetComponent<CircleCollider2D>()->OnCollisionEnter.addHandler(
+                [ball](Collider2D *collider) {
+                    ball->GetComponent<BallStateMachine>()->OnCollisionEnter(collider);
+                });
+
+            GameObjectManager::GetInstance()->AddGameObject(ball);
+        }
+
+        for (int i = 0; i < walls; i++) {
+            GameObject *wall = new GameObject("StressWall" + std::to_string(i));
+            wall->tag = 4;
+            wall->transform.position = Vector2(randomX(rng), randomY(rng));
+            wall->transform.scale = Vector2(2, 2);
+            wall->AddComponent(new SpriteRenderer(wall, Vector2(15, 30), 1, wallTexture));
+            wall->AddComponent(new BoxCollider2D(wall, Vector2(0, 0), Vector2(15 * 2, 30 * 2)));
+            GameObjectManager::GetInstance()->AddGameObject(wall);
+        }
+
+        for (int i = 0; i < decorations; i++) {
+            GameObject *decoration = GameObject::Instantiate("StressDecoration" + std::to_string(i), decorationTemplate, Vector2(randomX(rng), randomY(rng)), 0, Vector2(1, 1));
+            decoration->GetComponent<Animator>()->Play("Float");
+            GameObjectManager::GetInstance()->AddGameObject(decoration);
+        }
+
+        delete playerTemplate;
+        delete ballTemplate;
+        delete decorationTemplate;
+
+        int entityCount = players + balls + walls + decorations;
+        std::cout << "Stress step " << stressStep << ": " << players << " players, " << balls << " balls, "
+                  << walls << " walls, " << decorations << " sprites" << std::endl;
+
+        GameObject *monitor = new GameObject("StressMonitor");
+        StressMonitor *stressMonitor = dynamic_cast<StressMonitor *>(monitor->AddComponent(
+            new StressMonitor(monitor, entityCount, stressConfig.framesPerStep, "stress_results.csv", stressStep == 0)));
+        stressMonitor->AddOnStepCompleteHandler([this]() {
+            stressStep++;
+            if (stressStep < stressConfig.steps) {
+                reloadScene = true;
+            } else {
+                SDL_Event quit;
+                quit.type = SDL_QUIT;
+                SDL_PushEvent(&quit);
+            }
+        });
+        GameObjectManager::GetInstance()->AddGameObject(monitor);
+    });
+
+    SceneManager::GetInstance()->AddScene(stressScene);
+
+    SceneManager::GetInstance()->LoadScene(state == STRESS ? "Stress" : "Loading");
 }
 
-void Game::handleEvents() {
+void Game::queueAssets() {
+    AssetLoader *loader = AssetLoader::GetInstance();
 
-    SDL_PollEvent(&Game::event);
+    // Nobody hears self-play, and decoding both tracks holds tens of megabytes of samples per match
+    if (!selfPlayMode) {
+        loader->QueueMusic("MenuBgm", "Assets/SFX/fairyfountain.mp3", 100);
+        loader->QueueMusic("GameBgm", "Assets/SFX/papyrus.mp3", 32);
+    }
+
+    // Collision sounds are the first to give up their voice
+    loader->QueueSound("ball_bounce", "Assets/SFX/ball_bounce.mp3", 128, 0);
+    loader->QueueSound("ball_kick", "Assets/SFX/ball_kick.mp3", 128, 1);
+
+    loader->QueueSound("Game_Over", "Assets/SFX/gameover.mp3", 128, 3);
+    loader->QueueSound("Goal", "Assets/SFX/score.mp3", 64, 2);
+
+    // Every overlapping frame of a wall contact asks for a bounce
+    SoundManager *soundManager = SoundManager::GetInstance();
+    soundManager->SetSoundLimits(soundManager->GetSoundId("ball_bounce"), 80, 3);
+
+    // Largest first, it takes the longest to decode
+    SDL_Rect visibleBackground = {(2560 - WIDTH) / 2, (1707 - HEIGHT) / 2, WIDTH, HEIGHT};
+    loader->QueueScaledTexture("Assets/Sprites/UI/MenuBG.jpg", WIDTH, HEIGHT, &visibleBackground);
+    loader->QueueTexture("Assets/Sprites/yard.png");
+
+    const char *textures[] = {
+        "Assets/Sprites/UI/Game_Name.png", "Assets/Sprites/UI/Play_button1p.png", "Assets/Sprites/UI/Play_Button2p.png",
+        "Assets/Sprites/UI/Play_button.png", "Assets/Sprites/UI/Quit_button.png", "Assets/Sprites/UI/GameOver.png",
+        "Assets/Sprites/football.png", "Assets/Sprites/football2.png", "Assets/Sprites/football3.png",
+        "Assets/Sprites/football4.png", "Assets/Sprites/football5.png", "Assets/Sprites/football6.png",
+        "Assets/Sprites/goal.png", "Assets/soccer_ball.png", "Assets/default.png", "Assets/wall.png",
+        "Assets/actor.png", "Assets/blue_indicator.png", "Assets/red_indicator.png"};
+    for (const char *path : textures) {
+        loader->QueueTexture(path);
+    }
+}
+
+void Game::handleEvents() {
+    PROFILE_ZONE("Input");
+
+    // Drain the whole queue, subscribed components get their actions while it is processed
+    InputManager *input = InputManager::GetInstance();
+    input->BeginTick();
+
+    SDL_Event event;
+    bool quit = false;
+    while (SDL_PollEvent(&event)) {
+        input->ProcessEvent(event);
+        if (event.type == SDL_QUIT)
+            quit = true;
+        if (event.type == SDL_RENDER_TARGETS_RESET)
+            RotatedSpriteCache::GetInstance()->Rebuild();
+        // Nothing reacts to hovering, everything else may change what static scenes show
+        if (event.type != SDL_MOUSEMOTION)
+            GameObjectManager::GetInstance()->RequestRedraw();
+    }
 
-    if (event.type == SDL_QUIT) {
+    if (quit) {
         isRunning = false;
         return;
     }
 
-    if (event.type == SDL_KEYDOWN) {
-        if (event.key.keysym.sym == SDLK_ESCAPE) {
-            state = MENU;
-            scoreTeam1 = scoreTeam2 = 0;
-            return;
-        }
+    // Self-play ends the process with the match, the harness reads this line
+    if (selfPlayMode && (scoreTeam1 + scoreTeam2 >= 5 || selfPlayFrames >= selfPlayConfig.maxFrames)) {
+        std::cout << "SelfPlay result: " << scoreTeam1 << " - " << scoreTeam2 << " in " << selfPlayFrames << " frames" << std::endl;
+        isRunning = false;
+        return;
     }
 
     //End condition
@@ -490,7 +800,18 @@ void Game::handleEvents() {
 }
 
 void Game::handleSceneChange() {
+    PROFILE_ZONE("SceneChange");
+    if (reloadScene) {
+        reloadScene = false;
+        SceneManager::GetInstance()->LoadScene(SceneManager::GetInstance()->GetCurrentScene()->GetName());
+        return;
+    }
+
     switch (state) {
+    case LOADING:
+        if (SceneManager::GetInstance()->GetCurrentScene()->GetName() != "Loading")
+            SceneManager::GetInstance()->LoadScene("Loading");
+        break;
     case MENU:
         if (SceneManager::GetInstance()->GetCurrentScene()->GetName() != "MainMenu")
             SceneManager::GetInstance()->LoadScene("MainMenu");
@@ -503,14 +824,56 @@ void Game::handleSceneChange() {
         if (SceneManager::GetInstance()->GetCurrentScene()->GetName() != "GameOver")
             SceneManager::GetInstance()->LoadScene("GameOver");
         break;
+    case STRESS:
+        if (SceneManager::GetInstance()->GetCurrentScene()->GetName() != "Stress")
+            SceneManager::GetInstance()->LoadScene("Stress");
+        break;
     }
 }
 
 void Game::update() {
+    // Keeps running after the loading screen, in case a scene got ahead of the loader
+    AssetLoader *loader = AssetLoader::GetInstance();
+    loader->Update(ASSET_UPLOAD_BUDGET_MS);
+    if (state == LOADING && loader->IsDone())
+        state = selfPlayMode ? GAME : MENU;
+    if (selfPlayMode && state == GAME)
+        selfPlayFrames++;
+
     SceneManager::GetInstance()->Update();
 }
 
+bool Game::canIdle() {
+    if (headless || showCounters || reloadScene)
+        return false;
+
+    Scene *scene = SceneManager::GetInstance()->GetCurrentScene();
+    return scene != nullptr && scene->IsStatic() && !GameObjectManager::GetInstance()->IsRedrawRequested();
+}
+
+void Game::waitForInput() {
+    PROFILE_ZONE("Idle");
+
+    Uint32 timeout = IDLE_MAX_WAIT_MS;
+    Uint32 nextUpdate = GameObjectManager::GetInstance()->GetNextScheduledUpdate();
+    if (nextUpdate != 0) {
+        Uint32 now = SDL_GetTicks();
+        if (nextUpdate <= now)
+            return;
+        timeout = std::min(timeout, nextUpdate - now);
+    }
+
+    // Only waits, the event stays queued for handleEvents
+    SDL_WaitEventTimeout(nullptr, (int)timeout);
+}
+
 void Game::render() {
+    // Static scenes keep the last presented frame until something changes
+    Scene *scene = SceneManager::GetInstance()->GetCurrentScene();
+    if (scene != nullptr && scene->IsStatic() && !showCounters && !GameObjectManager::GetInstance()->IsRedrawRequested())
+        return;
+
+    PROFILE_ZONE("Render");
     SDL_RenderClear(renderer);
     SceneManager::GetInstance()->Draw();
 
@@ -540,16 +903,90 @@ void Game::render() {
         }
     }
 
+    if (showCounters) {
+        renderCounters();
+    }
+
+    PROFILE_ZONE("Present");
     SDL_RenderPresent(renderer);
 }
 
+void Game::renderCounters() {
+    // Text textures are slow to make, refresh them a few times a second
+    if (counterRefreshFrame <= 0) {
+        counterRefreshFrame = FPS / 4;
+        SDL_Color textColor = {255, 255, 255, 255};
+        for (int i = 0; i < COUNTER_COUNT; i++) {
+            if (counterTextures[i]) {
+                SDL_DestroyTexture(counterTextures[i]);
+            }
+            std::string text = std::string(Counters::GetName((Counter)i)) + ": " + std::to_string(Counters::GetLastFrame((Counter)i));
+            counterTextures[i] = LoadFontTexture(text, "Assets/Fonts/arial.ttf", textColor, 16);
+        }
+
+        // Last 10 seconds
+        char text[128];
+        for (int i = 0; i < FRAME_TIMER_COUNT; i++) {
+            if (frameStatTextures[i]) {
+                SDL_DestroyTexture(frameStatTextures[i]);
+            }
+            FrameTimer timer = (FrameTimer)i;
+            snprintf(text, sizeof(text), "%s ms: p50 %.2f  p95 %.2f  p99 %.2f  max %.2f", FrameStats::GetName(timer),
+                     FrameStats::GetPercentile(timer, 50, true), FrameStats::GetPercentile(timer, 95, true),
+                     FrameStats::GetPercentile(timer, 99, true), FrameStats::GetMax(timer, true));
+            frameStatTextures[i] = LoadFontTexture(text, "Assets/Fonts/arial.ttf", textColor, 16);
+        }
+    }
+    counterRefreshFrame--;
+
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        if (!counterTextures[i])
+            continue;
+        int width, height;
+        SDL_QueryTexture(counterTextures[i], nullptr, nullptr, &width, &height);
+        RenderTexture(counterTextures[i], 10 + width / 2, 10 + i * 20 + height / 2);
+    }
+
+    for (int i = 0; i < FRAME_TIMER_COUNT; i++) {
+        if (!frameStatTextures[i])
+            continue;
+        int width, height;
+        SDL_QueryTexture(frameStatTextures[i], nullptr, nullptr, &width, &height);
+        RenderTexture(frameStatTextures[i], 10 + width / 2, 10 + (COUNTER_COUNT + i) * 20 + height / 2);
+    }
+}
+
 void Game::clean() {
+    // Stops the workers before the subsystems they use go away
+    delete AssetLoader::GetInstance();
     delete SceneManager::GetInstance();
+    // After the scene, the AI controllers leave it when destroyed
+    AIBlackboard::DestroyInstance();
+
+    for (int id : inputSubscriptions) {
+        InputManager::GetInstance()->Unsubscribe(id);
+    }
+    inputSubscriptions.clear();
+
+    for (auto &texture : counterTextures) {
+        if (texture) {
+            SDL_DestroyTexture(texture);
+            texture = nullptr;
+        }
+    }
+    for (auto &texture : frameStatTextures) {
+        if (texture) {
+            SDL_DestroyTexture(texture);
+            texture = nullptr;
+        }
+    }
 
     for (auto &texture : TEXTURES) {
         SDL_DestroyTexture(texture);
     }
     TEXTURES.clear();
+    ClearSpriteSheetCache();
+    RotatedSpriteCache::GetInstance()->Clear();
 
     SDL_DestroyWindow(window);
     SDL_DestroyRenderer(renderer);
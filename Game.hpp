@@ -2,6 +2,10 @@
 #define GAME_HPP
 
 #include<SDL2/SDL.h>
+#include "AIParams.hpp"
+#include "Profiler.hpp"
+#include <random>
+#include <vector>
 class Game{
 
 public:    
@@ -9,25 +13,80 @@ public:
     ~Game();
 
     enum State{
+        LOADING,
         MENU,
         GAME,
-        GAMEOVER
+        GAMEOVER,
+        STRESS
     };
 
     State state = MENU;
 
+    // Synthetic workload for scaling tests, entity counts double on every step
+    struct StressConfig {
+        int players = 50;
+        int balls = 10;
+        int walls = 10;
+        int decorations = 100;
+        int steps = 1;
+        int framesPerStep = 600;
+        unsigned int seed = 1234;
+    };
+
+    bool stressMode = false;
+    StressConfig stressConfig;
+    int stressStep = 0;
+
+    // Headless AI-vs-AI match for tuning, reports the score and quits. Run in batches by SelfPlay.
+    struct SelfPlayConfig {
+        // Seeds the nudge the ball gets at every kickoff, the only thing that differs between matches
+        unsigned int seed = 1;
+        // Undecided matches end here, 10 minutes at 60 FPS
+        int maxFrames = 36000;
+    };
+
+    bool selfPlayMode = false;
+    SelfPlayConfig selfPlayConfig;
+    int selfPlayFrames = 0;
+
+    // AI tuning of each team, indexed by tag - 1
+    AIParams aiParams[2];
+
+    // No visible window, no rendering and no frame delay
+    bool headless = false;
+    // Whether the renderer was created with vsync, set by init
+    bool vsync = false;
+
     void init(const char* title, int xpos, int ypos, int width, int height, bool fullscreen);
     void objectInit();
+    // Hands every asset the scenes use to the AssetLoader
+    void queueAssets();
     void handleEvents();
     void handleSceneChange();
     void update();
     void render();
     void clean();
+    void renderCounters();
+
+    // True when the current scene is static and nothing needs updating or drawing
+    bool canIdle();
+    // Blocks until input arrives or the next animation frame is due
+    void waitForInput();
 
     bool running();
     bool reseting();
 
-    static SDL_Event event;
+    // Work time of the previous frame in milliseconds, measured by the main loop
+    static float frameTime;
+
+    /*Milliseconds of game time, for cooldowns that should follow the simulation.
+    The wall clock, except in self-play where frames aren't paced and every update counts as one frame at FPS.
+    */
+    static Uint32 GetTime();
+    static bool simulatedTime;
+
+    // Workers of the AI decision pool, 0 decides on the main thread. Self-play runs a match per core and uses 0.
+    static int aiThreadCount;
 
     int scoreTeam1 = 0;
     int scoreTeam2 = 0;
@@ -35,8 +94,21 @@ public:
 private: 
     bool isRunning;
     bool reset = false;
+    bool reloadScene = false;
     SDL_Window *window;
     SDL_Renderer *renderer;    
+
+    // Global hotkeys, dropped in clean so a reset doesn't subscribe twice
+    std::vector<int> inputSubscriptions;
+    void subscribeHotkeys();
+
+    // Live counters overlay, toggled with F3
+    bool showCounters = false;
+    SDL_Texture *counterTextures[COUNTER_COUNT] = {nullptr};
+    SDL_Texture *frameStatTextures[FRAME_TIMER_COUNT] = {nullptr};
+    int counterRefreshFrame = 0;
+
+    std::mt19937 selfPlayRng;
 };
 
 #endif // GAME_HPP
\ No newline at end of file
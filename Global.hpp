@@ -16,11 +16,25 @@
 extern SDL_Renderer* RENDERER;
 extern std::vector<SDL_Texture *> TEXTURES;
 
+// Packed assets, built with `make pack`. Files missing from it are loaded from Assets/
+#define ASSET_ARCHIVE_PATH "Assets.pak"
+
+// Imported assets, see LoadSpriteSheetScaled and AudioCache
+#define ASSET_CACHE_DIR "Assets/Cache/"
+// Keep decoded audio in ASSET_CACHE_DIR between runs, reading it back beats decoding the MP3s again
+const bool AUDIO_DISK_CACHE = true;
+
 //SETTINGS
 const int FPS = 60;
 const int WIDTH = 1280, HEIGHT = 720;
 // const int WIDTH = 1920, HEIGHT = 1080;
 const bool FULLSCREEN = true;
+// Let the present call pace frames, falls back to the timer when the renderer can't vsync
+const bool VSYNC = false;
+// Longest a static scene blocks waiting for input before running a frame anyway
+const int IDLE_MAX_WAIT_MS = 1000;
+// Main thread time per frame spent turning decoded images into textures while loading
+const double ASSET_UPLOAD_BUDGET_MS = 4.0;
 
 const float HIGH_KICK_FORCE = 17.0f;
 const float LOW_KICK_FORCE = 12.0f;
@@ -29,6 +43,13 @@ const float GoalKeeperSpeed = 15.0f;
 const float DefenderSpeed = 10.0f;
 const float AttackerSpeed = 11.0f;
 
+// AI influence map, cell size in pixels and how many cells a player's influence reaches
+const float INFLUENCE_CELL_SIZE = 40.0f;
+const int INFLUENCE_RADIUS = 4;
+
+// Key bindings, reloaded with F5
+#define INPUT_BINDINGS_PATH "Assets/Config/input.cfg"
+
 static bool Player2Mode = false;
 static bool TestMode = false;
 
@@ -2,10 +2,13 @@
 #define HELPER_HPP
 
 #include "Global.hpp"
+#include "AssetArchive.hpp"
 #include "CustomClasses.hpp"
 #include "Physic2D.hpp"
+#include "Profiler.hpp"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
+#include <algorithm>
 
 
 // Player cosmetics
@@ -99,10 +102,14 @@ public:
 };
 
 class StayInBounds : public Component {
+private:
+    SoundId bounceSound = INVALID_SOUND;
+
 public:
     bool teleport = false;
     StayInBounds(GameObject *parent, bool teleport) : Component(parent) {
         this->teleport = teleport;
+        bounceSound = SoundManager::GetInstance()->GetSoundId("ball_bounce");
     }
 
     ~StayInBounds() {}
@@ -163,7 +170,7 @@ public:
             }
         }
         if (bounced){
-            SoundManager::GetInstance()->PlaySound("ball_bounce");
+            SoundManager::GetInstance()->PlaySound(bounceSound, this->gameObject->transform.position);
         }
     }
 
@@ -175,9 +182,47 @@ public:
     }
 };
 
+// Loading screen, a bar centred on the object filled to the share returned by progress
+class ProgressBar : public Component {
+private:
+    Vector2 size;
+    std::function<float()> progress;
+
+public:
+    ProgressBar(GameObject *parent, Vector2 size, std::function<float()> progress) : Component(parent) {
+        this->size = size;
+        this->progress = progress;
+    }
+
+    void Update() {}
+
+    void Draw() {
+        Uint8 red, green, blue, alpha;
+        SDL_GetRenderDrawColor(RENDERER, &red, &green, &blue, &alpha);
+
+        float filled = std::max(0.0f, std::min(1.0f, progress()));
+        SDL_Rect frame = {(int)(gameObject->transform.position.x - size.x / 2), (int)(gameObject->transform.position.y - size.y / 2),
+                          (int)size.x, (int)size.y};
+        SDL_Rect bar = {frame.x + 4, frame.y + 4, (int)((frame.w - 8) * filled), frame.h - 8};
+
+        SDL_SetRenderDrawColor(RENDERER, 255, 255, 255, 255);
+        SDL_RenderDrawRect(RENDERER, &frame);
+        SDL_RenderFillRect(RENDERER, &bar);
+        Counters::Increment(COUNTER_DRAW_CALLS, 2);
+
+        SDL_SetRenderDrawColor(RENDERER, red, green, blue, alpha);
+    }
+
+    Component *Clone(GameObject *parent) {
+        return new ProgressBar(parent, size, progress);
+    }
+};
+
 SDL_Texture* LoadFontTexture(const std::string& text, const std::string& fontPath, SDL_Color color, int fontSize) {
+    PROFILE_ZONE_DETAIL("LoadFontTexture", text.c_str());
+
     // Load the font
-    TTF_Font* font = TTF_OpenFont(fontPath.c_str(), fontSize);
+    TTF_Font* font = TTF_OpenFontRW(OpenAsset(fontPath), 1, fontSize);
     if (!font) {
         std::cerr << "Failed to load font: " << TTF_GetError() << std::endl;
         return nullptr;
@@ -219,5 +264,6 @@ void RenderTexture(SDL_Texture* texture, int x, int y) {
 
     // Render the texture
     SDL_RenderCopy(RENDERER, texture, nullptr, &destRect);
+    Counters::Increment(COUNTER_DRAW_CALLS);
 }
 #endif // HELPER_HPP
\ No newline at end of file
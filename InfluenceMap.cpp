@@ -0,0 +1,159 @@
+#include "InfluenceMap.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Kernel value at the source's own cell
+static const int KERNEL_PEAK = 16;
+// How much an opponent's influence outweighs a cell of progress when looking for open space
+static const float OPEN_SPACE_PRESSURE_WEIGHT = 0.5f;
+
+InfluenceMap::InfluenceMap(float width, float height, float cellSize, int kernelRadius) {
+    this->cellSize = cellSize;
+    columns = std::max(1, (int)std::ceil(width / cellSize));
+    rows = std::max(1, (int)std::ceil(height / cellSize));
+
+    for (int team = 0; team < TEAM_COUNT; team++) {
+        influence[team].assign(columns * rows, 0);
+    }
+
+    // Linear falloff to 0 just past the radius
+    this->kernelRadius = kernelRadius;
+    kernelSize = kernelRadius * 2 + 1;
+    kernel.resize(kernelSize * kernelSize);
+    for (int y = 0; y < kernelSize; y++) {
+        for (int x = 0; x < kernelSize; x++) {
+            float distance = std::sqrt((float)((x - kernelRadius) * (x - kernelRadius) + (y - kernelRadius) * (y - kernelRadius)));
+            float falloff = std::max(0.0f, 1 - distance / (kernelRadius + 1));
+            kernel[y * kernelSize + x] = (int)std::lround(KERNEL_PEAK * falloff);
+        }
+    }
+}
+
+void InfluenceMap::Stamp(int team, int cellX, int cellY, int scale) {
+    int xStart = std::max(0, cellX - kernelRadius), xEnd = std::min(columns - 1, cellX + kernelRadius);
+    int yStart = std::max(0, cellY - kernelRadius), yEnd = std::min(rows - 1, cellY + kernelRadius);
+    int count = xEnd - xStart + 1;
+
+    for (int y = yStart; y <= yEnd; y++) {
+        // Contiguous rows on both sides, the compiler vectorises the inner loop
+        int *row = influence[team].data() + y * columns + xStart;
+        const int *kernelRow = kernel.data() + (y - cellY + kernelRadius) * kernelSize + (xStart - cellX + kernelRadius);
+        for (int x = 0; x < count; x++) {
+            row[x] += kernelRow[x] * scale;
+        }
+    }
+}
+
+void InfluenceMap::Unstamp(Source &source) {
+    if (source.cellX >= 0 && source.stampedTeam >= 0)
+        Stamp(source.stampedTeam, source.cellX, source.cellY, -source.weight);
+    source.cellX = source.cellY = -1;
+    source.stampedTeam = -1;
+}
+
+int InfluenceMap::GetCellIndex(Vector2 position) const {
+    int x = std::max(0, std::min(columns - 1, (int)(position.x / cellSize)));
+    int y = std::max(0, std::min(rows - 1, (int)(position.y / cellSize)));
+    return y * columns + x;
+}
+
+int InfluenceMap::AddSource(int team, int weight) {
+    Source source;
+    source.team = team;
+    source.weight = weight;
+    source.active = true;
+
+    for (size_t i = 0; i < sources.size(); i++) {
+        if (!sources[i].active) {
+            sources[i] = source;
+            return (int)i;
+        }
+    }
+    sources.push_back(source);
+    return (int)sources.size() - 1;
+}
+
+void InfluenceMap::RemoveSource(int index) {
+    if (index < 0 || index >= (int)sources.size())
+        return;
+    Unstamp(sources[index]);
+    sources[index].active = false;
+}
+
+void InfluenceMap::MoveSource(int index, Vector2 position, int team) {
+    if (index < 0 || index >= (int)sources.size() || !sources[index].active)
+        return;
+
+    Source &source = sources[index];
+    int cellX = std::max(0, std::min(columns - 1, (int)(position.x / cellSize)));
+    int cellY = std::max(0, std::min(rows - 1, (int)(position.y / cellSize)));
+    if (cellX == source.cellX && cellY == source.cellY && team == source.stampedTeam)
+        return;
+
+    Unstamp(source);
+    source.team = team;
+    if (team < 0 || team >= TEAM_COUNT)
+        return;
+    Stamp(team, cellX, cellY, source.weight);
+    source.cellX = cellX;
+    source.cellY = cellY;
+    source.stampedTeam = team;
+}
+
+int InfluenceMap::GetInfluence(int team, Vector2 position) const {
+    if (team < 0 || team >= TEAM_COUNT)
+        return 0;
+    return influence[team][GetCellIndex(position)];
+}
+
+Vector2 InfluenceMap::FindOpenSpace(int team, Vector2 around, float radius, Vector2 towards) const {
+    if (team < 0 || team >= TEAM_COUNT)
+        return around;
+    const std::vector<int> &opponent = influence[1 - team];
+
+    Vector2 direction = towards.Magnitude() > 0 ? towards.Normalize() : Vector2(0, 0);
+    int cellRadius = (int)std::ceil(radius / cellSize);
+    int centerX = std::max(0, std::min(columns - 1, (int)(around.x / cellSize)));
+    int centerY = std::max(0, std::min(rows - 1, (int)(around.y / cellSize)));
+
+    Vector2 best = around;
+    float bestScore = 0;
+    bool found = false;
+    for (int y = std::max(0, centerY - cellRadius); y <= std::min(rows - 1, centerY + cellRadius); y++) {
+        for (int x = std::max(0, centerX - cellRadius); x <= std::min(columns - 1, centerX + cellRadius); x++) {
+            Vector2 center((x + 0.5f) * cellSize, (y + 0.5f) * cellSize);
+            Vector2 offset = center - around;
+            if (offset.Magnitude() > radius)
+                continue;
+
+            float progress = (offset.x * direction.x + offset.y * direction.y) / cellSize;
+            float score = progress - opponent[y * columns + x] * OPEN_SPACE_PRESSURE_WEIGHT;
+            if (!found || score > bestScore) {
+                best = center;
+                bestScore = score;
+                found = true;
+            }
+        }
+    }
+    return best;
+}
+
+int InfluenceMap::GetLaneRisk(int team, Vector2 from, Vector2 to) const {
+    if (team < 0 || team >= TEAM_COUNT)
+        return 0;
+    const std::vector<int> &opponent = influence[1 - team];
+
+    // Two samples per cell crossed
+    Vector2 offset = to - from;
+    int steps = std::max(1, (int)std::ceil(offset.Magnitude() * 2 / cellSize));
+    int risk = 0;
+    for (int step = 0; step <= steps; step++) {
+        risk = std::max(risk, opponent[GetCellIndex(from + offset * ((float)step / steps))]);
+    }
+    return risk;
+}
+
+float InfluenceMap::GetCellSize() const {
+    return cellSize;
+}
@@ -0,0 +1,64 @@
+#ifndef INFLUENCEMAP_HPP
+#define INFLUENCEMAP_HPP
+
+#include "CustomClasses.hpp"
+
+/*Coarse grid over the pitch holding how strongly each team covers every cell.
+Every source (a player, the ball for whoever has it) stamps a falloff kernel around its cell into its
+team's layer. Stamps are integers and a source is only restamped when it changes cell or team, so a tick
+costs a few kernel rows per moving source, however many players there are.
+Teams are 0 and 1 (tag - 1), -1 for a source that counts for nobody.
+*/
+class InfluenceMap {
+public:
+    static const int TEAM_COUNT = 2;
+
+private:
+    struct Source {
+        int team = -1;
+        int weight = 1;
+        bool active = false;
+        // Where it is stamped, cellX -1 if it isn't
+        int cellX = -1, cellY = -1;
+        int stampedTeam = -1;
+    };
+
+    int columns = 0, rows = 0;
+    float cellSize = 1;
+
+    int kernelRadius = 0;
+    int kernelSize = 0;
+    std::vector<int> kernel;
+
+    std::vector<int> influence[TEAM_COUNT];
+
+    std::vector<Source> sources;
+
+    // Adds the kernel times sign around a cell, clipped to the grid
+    void Stamp(int team, int cellX, int cellY, int scale);
+    void Unstamp(Source &source);
+
+    int GetCellIndex(Vector2 position) const;
+
+public:
+    InfluenceMap(float width, float height, float cellSize, int kernelRadius);
+
+    // Handle for a new source, weight scales its kernel
+    int AddSource(int team, int weight);
+    void RemoveSource(int source);
+    // Restamps the source if it moved to another cell or team
+    void MoveSource(int source, Vector2 position, int team);
+
+    int GetInfluence(int team, Vector2 position) const;
+
+    /*Centre of the cell within radius of around that is most open for team: little opponent influence,
+    further along towards (a direction, may be zero) breaking ties. Stays on the grid.
+    */
+    Vector2 FindOpenSpace(int team, Vector2 around, float radius, Vector2 towards) const;
+    // Strongest opponent influence on the cells between from and to, how contested a pass along it is
+    int GetLaneRisk(int team, Vector2 from, Vector2 to) const;
+
+    float GetCellSize() const;
+};
+
+#endif // INFLUENCEMAP_HPP
@@ -0,0 +1,185 @@
+// Packs the game's assets into one archive, see AssetArchive.hpp for the layout.
+// Build and run with `make pack`, or `packer <archive> <directory> [--exclude=<directory>]...`.
+// Files are stored under their path relative to the working directory, e.g. Assets/Sprites/yard.png,
+// which is the path the game asks for. Only file types the game loads are packed.
+// Only SDL's headers are used, keep them from renaming main to SDL_main so the packer links without SDL.
+#define SDL_MAIN_HANDLED
+#include "AssetArchive.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+struct PackedFile {
+    std::string name;
+    ArchiveEntryType type;
+    Uint32 offset = 0;
+    Uint32 size = 0;
+};
+
+static std::vector<std::string> excluded;
+
+// -1 for files the game never loads
+static int GetEntryType(const std::string &name) {
+    size_t dot = name.find_last_of('.');
+    if (dot == std::string::npos)
+        return -1;
+
+    std::string extension = name.substr(dot + 1);
+    for (char &c : extension) {
+        c = (char)tolower((unsigned char)c);
+    }
+
+    if (extension == "png" || extension == "jpg" || extension == "jpeg" || extension == "bmp" || extension == "tex")
+        return ARCHIVE_ENTRY_IMAGE;
+    if (extension == "mp3" || extension == "wav" || extension == "ogg")
+        return ARCHIVE_ENTRY_AUDIO;
+    if (extension == "ttf")
+        return ARCHIVE_ENTRY_FONT;
+    return -1;
+}
+
+static void CollectFiles(const std::string &directory, std::vector<PackedFile> &files) {
+    if (std::find(excluded.begin(), excluded.end(), directory) != excluded.end())
+        return;
+
+    DIR *dir = opendir(directory.c_str());
+    if (!dir) {
+        std::cerr << "Failed to open directory: " << directory << std::endl;
+        return;
+    }
+
+    std::vector<std::string> names;
+    while (dirent *entry = readdir(dir)) {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+            names.push_back(entry->d_name);
+    }
+    closedir(dir);
+
+    // Same archive for the same files, whatever order the file system lists them in
+    std::sort(names.begin(), names.end());
+
+    for (auto &name : names) {
+        std::string path = directory + "/" + name;
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0)
+            continue;
+
+        if (S_ISDIR(info.st_mode)) {
+            CollectFiles(path, files);
+            continue;
+        }
+
+        int type = GetEntryType(name);
+        if (type < 0)
+            continue;
+
+        PackedFile file;
+        file.name = path;
+        file.type = (ArchiveEntryType)type;
+        file.size = (Uint32)info.st_size;
+        files.push_back(file);
+    }
+}
+
+static void WriteUint32(std::ostream &out, Uint32 value) {
+    value = SDL_SwapLE32(value);
+    out.write((const char *)&value, sizeof(value));
+}
+
+static void WriteUint16(std::ostream &out, Uint16 value) {
+    value = SDL_SwapLE16(value);
+    out.write((const char *)&value, sizeof(value));
+}
+
+static Uint32 Align(Uint32 offset) {
+    return (offset + ARCHIVE_ALIGNMENT - 1) / ARCHIVE_ALIGNMENT * ARCHIVE_ALIGNMENT;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: packer <archive> <directory> [--exclude=<directory>]..." << std::endl;
+        return 1;
+    }
+
+    std::string archivePath = argv[1];
+    std::string root = argv[2];
+    while (!root.empty() && (root.back() == '/' || root.back() == '\\'))
+        root.pop_back();
+
+    for (int i = 3; i < argc; i++) {
+        if (strncmp(argv[i], "--exclude=", 10) == 0) {
+            std::string directory = argv[i] + 10;
+            while (!directory.empty() && (directory.back() == '/' || directory.back() == '\\'))
+                directory.pop_back();
+            excluded.push_back(directory);
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+        }
+    }
+
+    std::vector<PackedFile> files;
+    CollectFiles(root, files);
+
+    Uint32 indexSize = 0;
+    for (auto &file : files) {
+        indexSize += 12 + (Uint32)file.name.size();
+    }
+
+    Uint32 offset = Align(sizeof(ArchiveHeader) + indexSize);
+    for (auto &file : files) {
+        file.offset = offset;
+        offset = Align(offset + file.size);
+    }
+
+    std::ofstream out(archivePath, std::ios::binary);
+    if (!out) {
+        std::cerr << "Failed to create archive: " << archivePath << std::endl;
+        return 1;
+    }
+
+    out.write(ARCHIVE_MAGIC, 4);
+    WriteUint32(out, ARCHIVE_VERSION);
+    WriteUint32(out, (Uint32)files.size());
+    WriteUint32(out, indexSize);
+
+    for (auto &file : files) {
+        WriteUint32(out, file.offset);
+        WriteUint32(out, file.size);
+        out.put((char)file.type);
+        out.put(0);
+        WriteUint16(out, (Uint16)file.name.size());
+        out.write(file.name.data(), file.name.size());
+    }
+
+    std::vector<char> buffer;
+    for (auto &file : files) {
+        // Padding up to the aligned start
+        while ((Uint32)out.tellp() < file.offset)
+            out.put(0);
+
+        std::ifstream in(file.name, std::ios::binary);
+        buffer.resize(file.size);
+        if (!in.read(buffer.data(), file.size)) {
+            std::cerr << "Failed to read: " << file.name << std::endl;
+            return 1;
+        }
+        out.write(buffer.data(), file.size);
+        std::cout << file.name << " (" << file.size << " bytes)" << std::endl;
+    }
+
+    if (!out) {
+        std::cerr << "Failed to write archive: " << archivePath << std::endl;
+        return 1;
+    }
+
+    std::cout << "Packed " << files.size() << " files into " << archivePath << " (" << out.tellp() << " bytes)" << std::endl;
+    return 0;
+}
@@ -1,4 +1,7 @@
 #include "Physic2D.hpp"
+#include "Profiler.hpp"
+
+#include <algorithm>
 
 CollisionManager *CollisionManager::instance = nullptr;
 
@@ -20,7 +23,6 @@ void Rigidbody2D::Update() {
 
     this->velocity = this->velocity * (1 - this->drag);
 
-    const float MINIMUM_VELOCITY = 0.05f;
     if (this->velocity.Magnitude() < MINIMUM_VELOCITY) {
         this->velocity = Vector2(0, 0);
     }
@@ -42,6 +44,21 @@ void Rigidbody2D::SetBounciness(float bounciness) {
     this->bounciness = bounciness;
 }
 
+float Rigidbody2D::GetDrag() {
+    return drag;
+}
+
+float Rigidbody2D::GetBounciness() {
+    return bounciness;
+}
+
+float Rigidbody2D::GetTerminalSpeed(float force) {
+    // v = (v + force / mass) * (1 - drag) settles where both sides are equal
+    if (drag <= 0)
+        return 0;
+    return force / mass * (1 - drag) / drag;
+}
+
 void Rigidbody2D::BounceOff(Vector2 normal) {
     if (Vector2::Dot(this->velocity, normal) > 0) {
         return;
@@ -111,25 +128,64 @@ void CollisionManager::RemoveCollider(Collider2D *collider) {
 }
 
 void CollisionManager::Update() {
-    for (auto &collider1 : this->colliders) {
-        if (!collider1->enabled) {
-            continue;
-        }
-        for (auto &collider2 : this->colliders) {
-            if (collider1->gameObject->GetName() == collider2->gameObject->GetName() || !collider2->enabled) {
+    PROFILE_ZONE("CollisionManager::Update");
+
+    // Broadphase: sweep along x over the bounding boxes, only overlapping ones get a narrowphase test.
+    // Both orders of a pair are kept, every collider gets to test against every other one.
+    {
+        PROFILE_ZONE("Collision.Broadphase");
+        this->entries.clear();
+        for (auto &collider : this->colliders) {
+            if (!collider->enabled) {
                 continue;
             }
+            BroadphaseEntry entry;
+            entry.collider = collider;
+            collider->GetBounds(entry.min, entry.max);
+            this->entries.push_back(entry);
+        }
 
-            if (collider1->CheckCollision(collider2)) {
-                collider1->OnCollisionEnter.raise(collider2);
-                collider2->OnCollisionEnter.raise(collider1);
+        std::sort(this->entries.begin(), this->entries.end(), [](const BroadphaseEntry &a, const BroadphaseEntry &b) {
+            return a.min.x < b.min.x;
+        });
+
+        this->pairs.clear();
+        for (size_t i = 0; i < this->entries.size(); i++) {
+            BroadphaseEntry &entry1 = this->entries[i];
+            for (size_t j = i + 1; j < this->entries.size() && this->entries[j].min.x <= entry1.max.x; j++) {
+                BroadphaseEntry &entry2 = this->entries[j];
+                if (entry1.max.y < entry2.min.y || entry2.max.y < entry1.min.y) {
+                    continue;
+                }
+                if (entry1.collider->gameObject == entry2.collider->gameObject) {
+                    continue;
+                }
+                this->pairs.push_back({entry1.collider, entry2.collider});
+                this->pairs.push_back({entry2.collider, entry1.collider});
             }
         }
     }
+
+    PROFILE_ZONE("Collision.Narrowphase");
+    int startGeneration = this->generation;
+    Counters::Increment(COUNTER_COLLISION_TESTS, (int)this->pairs.size());
+    for (auto &pair : this->pairs) {
+        if (pair.first->CheckCollision(pair.second)) {
+            Counters::Increment(COUNTER_COLLISION_HITS);
+            pair.first->OnCollisionEnter.raise(pair.second);
+            // A handler reloaded the scene, the remaining pairs point to deleted colliders
+            if (this->generation != startGeneration)
+                return;
+            pair.second->OnCollisionEnter.raise(pair.first);
+            if (this->generation != startGeneration)
+                return;
+        }
+    }
 }
 
 void CollisionManager::Clear() {
     this->colliders.clear();
+    this->generation++;
 }
 
 // CircleCollider2D Implementation
@@ -178,6 +234,12 @@ Vector2 CircleCollider2D::GetNormal(Vector2 point) {
     return (point - this->gameObject->transform.position).Normalize();
 }
 
+void CircleCollider2D::GetBounds(Vector2 &min, Vector2 &max) {
+    Vector2 center = this->gameObject->transform.position + this->offset;
+    min = Vector2(center.x - this->radius, center.y - this->radius);
+    max = Vector2(center.x + this->radius, center.y + this->radius);
+}
+
 // BoxCollider2D Implementation
 BoxCollider2D::BoxCollider2D(GameObject *parent, Vector2 offset, Vector2 size) : Collider2D(parent, offset) {
     this->size = size;
@@ -256,6 +318,11 @@ Vector2 BoxCollider2D::GetNormal(Vector2 point) {
     return Vector2(0, 0);
 }
 
+void BoxCollider2D::GetBounds(Vector2 &min, Vector2 &max) {
+    min = this->gameObject->transform.position - this->size / 2 + this->offset;
+    max = this->gameObject->transform.position + this->size / 2 + this->offset;
+}
+
 // General Collision Functions
 bool CheckCollision(CircleCollider2D *circle, BoxCollider2D *box) {
     // Calculate the circle's center with offset
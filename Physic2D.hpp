@@ -11,6 +11,9 @@ private:
     float mass, drag, bounciness;
 
 public:
+    // Slower than this per tick counts as resting
+    static constexpr float MINIMUM_VELOCITY = 0.05f;
+
     Vector2 velocity;
 
     Rigidbody2D(GameObject *parent, float mass, float drag, float bounciness);
@@ -22,6 +25,10 @@ public:
 
     void SetDrag(float drag);
     void SetBounciness(float bounciness);
+    float GetDrag();
+    float GetBounciness();
+    // Speed per tick the body settles at when force is added every tick, 0 without drag (it never settles)
+    float GetTerminalSpeed(float force);
 
     void BounceOff(Vector2 normal);
 
@@ -47,6 +54,8 @@ public:
     virtual bool CheckCollision(Collider2D *other) = 0;
     virtual bool CheckCollision(Vector2 point) = 0;
     virtual Vector2 GetNormal(Vector2 point) = 0;
+    // World space bounding box, used by the broadphase
+    virtual void GetBounds(Vector2 &min, Vector2 &max) = 0;
 };
 
 class CollisionManager {
@@ -55,6 +64,17 @@ private:
     static CollisionManager *instance;
 
     std::vector<Collider2D *> colliders;
+    struct BroadphaseEntry {
+        Vector2 min, max;
+        Collider2D *collider;
+    };
+
+    // Kept between updates to reuse the allocations
+    std::vector<BroadphaseEntry> entries;
+    // Candidate pairs from the broadphase
+    std::vector<std::pair<Collider2D *, Collider2D *>> pairs;
+    // Bumped by Clear, lets Update notice a scene reload from inside a collision handler
+    int generation = 0;
 
 public:
     static CollisionManager *GetInstance();
@@ -86,6 +106,7 @@ public:
     bool CheckCollision(Vector2 point);
 
     Vector2 GetNormal(Vector2 point);
+    void GetBounds(Vector2 &min, Vector2 &max);
 };
 
 class BoxCollider2D : public Collider2D {
@@ -106,6 +127,7 @@ public:
     bool CheckCollision(Vector2 point);
 
     Vector2 GetNormal(Vector2 point);
+    void GetBounds(Vector2 &min, Vector2 &max);
 };
 
 bool CheckCollision(CircleCollider2D *circle, BoxCollider2D *box);
@@ -0,0 +1,547 @@
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <vector>
+
+TraceRecorder *TraceRecorder::instance = nullptr;
+
+#pragma region TraceRecorder
+
+TraceRecorder::TraceRecorder() {
+    slots = new Slot[CAPACITY];
+    for (int i = 0; i < CAPACITY; i++) {
+        SDL_AtomicSet(&slots[i].sequence, 0);
+    }
+    SDL_AtomicSet(&head, 0);
+
+    origin = SDL_GetPerformanceCounter();
+    ticksToMicroseconds = 1000000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+TraceRecorder::~TraceRecorder() {
+    delete[] slots;
+    instance = nullptr;
+}
+
+TraceRecorder *TraceRecorder::GetInstance() {
+    if (instance == nullptr) {
+        instance = new TraceRecorder();
+    }
+    return instance;
+}
+
+void TraceRecorder::Record(const char *name, const char *detail, Uint64 start, Uint64 end) {
+    Uint32 index = (Uint32)SDL_AtomicAdd(&head, 1);
+    Slot &slot = slots[index & (CAPACITY - 1)];
+
+    // Mark as being written so a concurrent Dump skips it
+    SDL_AtomicSet(&slot.sequence, 0);
+
+    slot.event.name = name;
+    slot.event.start = start;
+    slot.event.end = end;
+    slot.event.thread = SDL_ThreadID();
+    if (detail != nullptr) {
+        strncpy(slot.event.detail, detail, sizeof(slot.event.detail) - 1);
+        slot.event.detail[sizeof(slot.event.detail) - 1] = '\0';
+    } else {
+        slot.event.detail[0] = '\0';
+    }
+
+    SDL_AtomicSet(&slot.sequence, (int)(index + 1));
+}
+
+static void WriteJsonString(std::ofstream &out, const char *text) {
+    out << '"';
+    for (const char *c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            out << '\\' << *c;
+        } else if ((unsigned char)*c < 0x20) {
+            out << ' ';
+        } else {
+            out << *c;
+        }
+    }
+    out << '"';
+}
+
+bool TraceRecorder::Dump(const std::string &path) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Failed to open trace file: " << path << std::endl;
+        return false;
+    }
+
+    Uint32 end = (Uint32)SDL_AtomicGet(&head);
+    Uint32 begin = end > (Uint32)CAPACITY ? end - CAPACITY : 0;
+
+    // Microsecond timestamps of a long session need more than the default 6 significant digits
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    int written = 0;
+    for (Uint32 index = begin; index != end; index++) {
+        Slot &slot = slots[index & (CAPACITY - 1)];
+
+        // Seqlock style read, drop the event if a writer touched it meanwhile
+        if ((Uint32)SDL_AtomicGet(&slot.sequence) != index + 1)
+            continue;
+        TraceEvent event = slot.event;
+        if ((Uint32)SDL_AtomicGet(&slot.sequence) != index + 1 || event.name == nullptr)
+            continue;
+
+        if (!first)
+            out << ",\n";
+        first = false;
+
+        out << "{\"name\":";
+        WriteJsonString(out, event.name);
+        out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << (unsigned long)event.thread
+            << ",\"ts\":" << (double)(Sint64)(event.start - origin) * ticksToMicroseconds
+            << ",\"dur\":" << (double)(event.end - event.start) * ticksToMicroseconds;
+        if (event.detail[0] != '\0') {
+            out << ",\"args\":{\"detail\":";
+            WriteJsonString(out, event.detail);
+            out << "}";
+        }
+        out << "}";
+        written++;
+    }
+    out << "\n]}\n";
+
+    std::cout << "Trace written to " << path << " (" << written << " events)" << std::endl;
+    return true;
+}
+
+void TraceRecorder::DumpNext() {
+    Dump("trace_" + std::to_string(dumpCount++) + ".json");
+}
+
+void TraceRecorder::Clear() {
+    for (int i = 0; i < CAPACITY; i++) {
+        SDL_AtomicSet(&slots[i].sequence, 0);
+    }
+    SDL_AtomicSet(&head, 0);
+}
+
+#pragma endregion
+
+#pragma region AllocationTracker
+
+#ifdef TRACK_ALLOCATIONS
+
+thread_local const char *ProfileZone::current = nullptr;
+
+namespace {
+    struct AllocationSite {
+        const char *zone;
+        void *caller;
+        Uint64 count, bytes;
+    };
+
+    struct FrameAllocations {
+        Uint64 frame, count, bytes;
+    };
+
+    // Fixed tables, operator new can't allocate to record itself
+    const int SITE_CAPACITY = 4096;
+    const int WORST_FRAME_COUNT = 10;
+
+    AllocationSite sites[SITE_CAPACITY];
+    FrameAllocations worstFrames[WORST_FRAME_COUNT];
+
+    SDL_SpinLock trackerLock = 0;
+    bool reporting = false;
+
+    Uint64 frameIndex = 0, frameCount = 0, frameBytes = 0;
+    Uint64 totalCount = 0, totalBytes = 0;
+    Uint64 zeroAllocationFrames = 0;
+    int droppedSites = 0;
+}
+
+void AllocationTracker::RecordAllocation(size_t size, void *caller) {
+    if (reporting)
+        return;
+
+    const char *zone = ProfileZone::current;
+
+    SDL_AtomicLock(&trackerLock);
+    frameCount++;
+    frameBytes += size;
+    totalCount++;
+    totalBytes += size;
+
+    size_t hash = ((size_t)zone * 31 + (size_t)caller) >> 3;
+    for (int probe = 0; probe < SITE_CAPACITY; probe++) {
+        AllocationSite &site = sites[(hash + probe) & (SITE_CAPACITY - 1)];
+        if (site.count == 0) {
+            site.zone = zone;
+            site.caller = caller;
+        } else if (site.zone != zone || site.caller != caller) {
+            continue;
+        }
+        site.count++;
+        site.bytes += size;
+        SDL_AtomicUnlock(&trackerLock);
+        return;
+    }
+    droppedSites++;
+    SDL_AtomicUnlock(&trackerLock);
+}
+
+void AllocationTracker::EndFrame() {
+    SDL_AtomicLock(&trackerLock);
+    if (frameCount == 0)
+        zeroAllocationFrames++;
+
+    // Keep the worst frames sorted, most allocations first
+    FrameAllocations current = {frameIndex, frameCount, frameBytes};
+    for (int i = 0; i < WORST_FRAME_COUNT; i++) {
+        if (current.count > worstFrames[i].count) {
+            std::swap(current, worstFrames[i]);
+        }
+    }
+
+    frameIndex++;
+    frameCount = frameBytes = 0;
+    SDL_AtomicUnlock(&trackerLock);
+}
+
+Uint64 AllocationTracker::GetTotalAllocations() {
+    return totalCount;
+}
+
+Uint64 AllocationTracker::GetTotalBytes() {
+    return totalBytes;
+}
+
+void AllocationTracker::Report() {
+    SDL_AtomicLock(&trackerLock);
+    reporting = true;
+    SDL_AtomicUnlock(&trackerLock);
+
+    std::vector<AllocationSite> topSites;
+    for (int i = 0; i < SITE_CAPACITY; i++) {
+        if (sites[i].count > 0)
+            topSites.push_back(sites[i]);
+    }
+    std::sort(topSites.begin(), topSites.end(), [](const AllocationSite &a, const AllocationSite &b) {
+        return a.count > b.count;
+    });
+
+    std::cout << "Allocations: " << totalCount << " (" << totalBytes << " bytes) over " << frameIndex << " frames, "
+              << zeroAllocationFrames << " frames without any" << std::endl;
+
+    std::cout << "Worst frames:" << std::endl;
+    for (int i = 0; i < WORST_FRAME_COUNT && worstFrames[i].count > 0; i++) {
+        std::cout << "  frame " << worstFrames[i].frame << ": " << worstFrames[i].count << " allocations, "
+                  << worstFrames[i].bytes << " bytes" << std::endl;
+    }
+
+    std::cout << "Top allocating sites:" << std::endl;
+    for (size_t i = 0; i < topSites.size() && i < 20; i++) {
+        std::cout << "  " << topSites[i].count << " allocations, " << topSites[i].bytes << " bytes in "
+                  << (topSites[i].zone ? topSites[i].zone : "(no zone)") << " from " << topSites[i].caller << std::endl;
+    }
+    if (droppedSites > 0)
+        std::cout << "  " << droppedSites << " allocations had no free site slot" << std::endl;
+
+    reporting = false;
+}
+
+void *operator new(size_t size) {
+    AllocationTracker::RecordAllocation(size, __builtin_return_address(0));
+    void *memory = malloc(size ? size : 1);
+    if (!memory)
+        throw std::bad_alloc();
+    return memory;
+}
+
+void *operator new[](size_t size) {
+    AllocationTracker::RecordAllocation(size, __builtin_return_address(0));
+    void *memory = malloc(size ? size : 1);
+    if (!memory)
+        throw std::bad_alloc();
+    return memory;
+}
+
+void operator delete(void *memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept {
+    free(memory);
+}
+
+void operator delete[](void *memory, size_t) noexcept {
+    free(memory);
+}
+
+#else
+
+void AllocationTracker::RecordAllocation(size_t, void *) {}
+void AllocationTracker::EndFrame() {}
+Uint64 AllocationTracker::GetTotalAllocations() { return 0; }
+Uint64 AllocationTracker::GetTotalBytes() { return 0; }
+void AllocationTracker::Report() {}
+
+#endif
+
+#pragma endregion
+
+#pragma region Counters
+
+int Counters::values[COUNTER_COUNT] = {0};
+int Counters::history[Counters::HISTORY_LENGTH][COUNTER_COUNT] = {{0}};
+Uint64 Counters::frameIndex = 0;
+
+void Counters::EndFrame() {
+    int *row = history[frameIndex % HISTORY_LENGTH];
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        row[i] = values[i];
+        values[i] = 0;
+    }
+    frameIndex++;
+}
+
+int Counters::GetLastFrame(Counter counter) {
+    if (frameIndex == 0)
+        return 0;
+    return history[(frameIndex - 1) % HISTORY_LENGTH][counter];
+}
+
+const char *Counters::GetName(Counter counter) {
+    switch (counter) {
+    case COUNTER_COLLISION_TESTS:
+        return "collision_tests";
+    case COUNTER_COLLISION_HITS:
+        return "collision_hits";
+    case COUNTER_DRAW_CALLS:
+        return "draw_calls";
+    case COUNTER_TEXTURE_SWITCHES:
+        return "texture_switches";
+    case COUNTER_SOUNDS_PLAYED:
+        return "sounds_played";
+    case COUNTER_VOICES_STOLEN:
+        return "voices_stolen";
+    case COUNTER_SOUNDS_DROPPED:
+        return "sounds_dropped";
+    case COUNTER_SOUNDS_COALESCED:
+        return "sounds_coalesced";
+    case COUNTER_GET_COMPONENT:
+        return "get_component";
+    case COUNTER_OBJECTS_UPDATED:
+        return "objects_updated";
+    case COUNTER_OBJECTS_DRAWN:
+        return "objects_drawn";
+    case COUNTER_AI_DECISIONS:
+        return "ai_decisions";
+    default:
+        return "unknown";
+    }
+}
+
+bool Counters::DumpCsv(const std::string &path) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Failed to open counters file: " << path << std::endl;
+        return false;
+    }
+
+    out << "frame";
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        out << "," << GetName((Counter)i);
+    }
+    out << "\n";
+
+    Uint64 first = frameIndex > HISTORY_LENGTH ? frameIndex - HISTORY_LENGTH : 0;
+    for (Uint64 frame = first; frame < frameIndex; frame++) {
+        int *row = history[frame % HISTORY_LENGTH];
+        out << frame;
+        for (int i = 0; i < COUNTER_COUNT; i++) {
+            out << "," << row[i];
+        }
+        out << "\n";
+    }
+
+    std::cout << "Counters written to " << path << " (" << frameIndex - first << " frames)" << std::endl;
+    return true;
+}
+
+#pragma endregion
+
+#pragma region FrameStats
+
+int FrameTimeHistogram::GetBucket(Uint32 value) {
+    if (value > MAX_VALUE)
+        value = MAX_VALUE;
+    if (value < (Uint32)SUB_BUCKETS)
+        return (int)value;
+
+    // Shift the value down to [SUB_BUCKETS / 2, SUB_BUCKETS), the shift picks the power of two
+    int highestBit = 31 - __builtin_clz(value);
+    int shift = highestBit - 5;
+    return SUB_BUCKETS + (shift - 1) * (SUB_BUCKETS / 2) + (int)(value >> shift) - SUB_BUCKETS / 2;
+}
+
+Uint32 FrameTimeHistogram::GetBucketValue(int bucket) {
+    if (bucket < SUB_BUCKETS)
+        return (Uint32)bucket;
+
+    int shift = (bucket - SUB_BUCKETS) / (SUB_BUCKETS / 2) + 1;
+    Uint32 subBucket = (Uint32)((bucket - SUB_BUCKETS) % (SUB_BUCKETS / 2) + SUB_BUCKETS / 2);
+    return (subBucket << shift) + (1u << (shift - 1));
+}
+
+void FrameTimeHistogram::Record(Uint32 value) {
+    buckets[GetBucket(value)]++;
+    count++;
+    sum += value;
+}
+
+void FrameTimeHistogram::Remove(Uint32 value) {
+    buckets[GetBucket(value)]--;
+    count--;
+    sum -= value;
+}
+
+void FrameTimeHistogram::Clear() {
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        buckets[i] = 0;
+    }
+    count = sum = 0;
+}
+
+double FrameTimeHistogram::GetMean() const {
+    return count > 0 ? (double)sum / count : 0;
+}
+
+Uint32 FrameTimeHistogram::GetPercentile(double percentile) const {
+    if (count == 0)
+        return 0;
+
+    Uint64 target = (Uint64)std::ceil(percentile / 100.0 * count);
+    if (target < 1)
+        target = 1;
+
+    Uint64 seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        seen += buckets[i];
+        if (seen >= target)
+            return GetBucketValue(i);
+    }
+    return GetMax();
+}
+
+Uint32 FrameTimeHistogram::GetMax() const {
+    for (int i = BUCKET_COUNT - 1; i >= 0; i--) {
+        if (buckets[i] > 0)
+            return GetBucketValue(i);
+    }
+    return 0;
+}
+
+FrameTimeHistogram FrameStats::total[FRAME_TIMER_COUNT];
+FrameTimeHistogram FrameStats::window[FRAME_TIMER_COUNT];
+Uint32 FrameStats::windowSamples[FRAME_TIMER_COUNT][FrameStats::WINDOW_FRAMES];
+Uint64 FrameStats::sampleCount[FRAME_TIMER_COUNT] = {0};
+
+void FrameStats::Record(FrameTimer timer, double milliseconds) {
+    Uint32 microseconds = milliseconds > 0 ? (Uint32)std::min(milliseconds * 1000.0, (double)FrameTimeHistogram::MAX_VALUE) : 0;
+
+    total[timer].Record(microseconds);
+
+    Uint32 &slot = windowSamples[timer][sampleCount[timer] % WINDOW_FRAMES];
+    if (sampleCount[timer] >= WINDOW_FRAMES)
+        window[timer].Remove(slot);
+    slot = microseconds;
+    window[timer].Record(microseconds);
+    sampleCount[timer]++;
+}
+
+double FrameStats::GetPercentile(FrameTimer timer, double percentile, bool rolling) {
+    return (rolling ? window : total)[timer].GetPercentile(percentile) / 1000.0;
+}
+
+double FrameStats::GetMax(FrameTimer timer, bool rolling) {
+    return (rolling ? window : total)[timer].GetMax() / 1000.0;
+}
+
+const char *FrameStats::GetName(FrameTimer timer) {
+    switch (timer) {
+    case FRAME_TOTAL:
+        return "total";
+    case FRAME_SIM:
+        return "sim";
+    case FRAME_RENDER:
+        return "render";
+    default:
+        return "unknown";
+    }
+}
+
+void FrameStats::Report() {
+    for (int i = 0; i < FRAME_TIMER_COUNT; i++) {
+        const FrameTimeHistogram &histogram = total[i];
+        if (histogram.GetCount() == 0)
+            continue;
+        std::cout << "Frame " << GetName((FrameTimer)i) << ": " << histogram.GetCount() << " frames, mean "
+                  << histogram.GetMean() / 1000.0 << " ms, p50 " << histogram.GetPercentile(50) / 1000.0
+                  << " ms, p95 " << histogram.GetPercentile(95) / 1000.0 << " ms, p99 "
+                  << histogram.GetPercentile(99) / 1000.0 << " ms, max " << histogram.GetMax() / 1000.0 << " ms"
+                  << std::endl;
+    }
+}
+
+bool FrameStats::DumpCsv(const std::string &path) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Failed to open frame stats file: " << path << std::endl;
+        return false;
+    }
+
+    out << "timer,frames,mean_ms,p50_ms,p90_ms,p95_ms,p99_ms,p99.9_ms,max_ms\n";
+    for (int i = 0; i < FRAME_TIMER_COUNT; i++) {
+        const FrameTimeHistogram &histogram = total[i];
+        out << GetName((FrameTimer)i) << "," << histogram.GetCount() << "," << histogram.GetMean() / 1000.0;
+        for (double percentile : {50.0, 90.0, 95.0, 99.0, 99.9}) {
+            out << "," << histogram.GetPercentile(percentile) / 1000.0;
+        }
+        out << "," << histogram.GetMax() / 1000.0 << "\n";
+    }
+
+    std::cout << "Frame stats written to " << path << std::endl;
+    return true;
+}
+
+bool FrameStats::DumpHistogramCsv(const std::string &path) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Failed to open frame histogram file: " << path << std::endl;
+        return false;
+    }
+
+    out << "timer,value_us,count\n";
+    for (int i = 0; i < FRAME_TIMER_COUNT; i++) {
+        for (int bucket = 0; bucket < FrameTimeHistogram::BUCKET_COUNT; bucket++) {
+            Uint32 bucketCount = total[i].GetBucketCount(bucket);
+            if (bucketCount > 0) {
+                out << GetName((FrameTimer)i) << "," << FrameTimeHistogram::GetBucketValue(bucket) << "," << bucketCount << "\n";
+            }
+        }
+    }
+    return true;
+}
+
+#pragma endregion
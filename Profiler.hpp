@@ -0,0 +1,227 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <SDL2/SDL.h>
+#include <string>
+
+// A finished profiler zone
+struct TraceEvent {
+    const char *name = nullptr;
+    char detail[48] = {0};
+    Uint64 start = 0, end = 0; // Performance counter ticks
+    SDL_threadID thread = 0;
+};
+
+/*Singleton recorder for profiler zones, dumped as Chrome/Perfetto trace JSON.
+Zones go into a fixed ring buffer, the oldest ones get overwritten.
+Writers claim a slot with an atomic increment, so any thread can record without locking.
+*/
+class TraceRecorder {
+private:
+    static const int CAPACITY = 1 << 16;
+
+    struct Slot {
+        SDL_atomic_t sequence; // Index + 1 of the event stored, 0 while being written
+        TraceEvent event;
+    };
+
+    Slot *slots = nullptr;
+    SDL_atomic_t head;
+
+    Uint64 origin = 0;
+    double ticksToMicroseconds = 0;
+
+    int dumpCount = 0;
+
+    TraceRecorder();
+    static TraceRecorder *instance;
+
+public:
+    ~TraceRecorder();
+    static TraceRecorder *GetInstance();
+
+    void Record(const char *name, const char *detail, Uint64 start, Uint64 end);
+
+    // Writes the events currently in the buffer, returns false if the file could not be opened
+    bool Dump(const std::string &path);
+    // Dumps to trace_<n>.json, used by the hotkey
+    void DumpNext();
+
+    void Clear();
+};
+
+// Records the lifetime of the scope as a zone. name must be a string literal.
+class ProfileZone {
+private:
+    const char *name;
+    const char *detail;
+    Uint64 start;
+#ifdef TRACK_ALLOCATIONS
+    const char *parent;
+#endif
+
+public:
+#ifdef TRACK_ALLOCATIONS
+    // Innermost open zone of the calling thread, allocations are attributed to it
+    static thread_local const char *current;
+#endif
+
+    ProfileZone(const char *name, const char *detail = nullptr) : name(name), detail(detail) {
+#ifdef TRACK_ALLOCATIONS
+        parent = current;
+        current = name;
+#endif
+        start = SDL_GetPerformanceCounter();
+    }
+
+    ~ProfileZone() {
+        TraceRecorder::GetInstance()->Record(name, detail, start, SDL_GetPerformanceCounter());
+#ifdef TRACK_ALLOCATIONS
+        current = parent;
+#endif
+    }
+};
+
+/*Per-frame heap allocation statistics, fed by the global operator new.
+The hooks only exist when built with TRACK_ALLOCATIONS (make TRACK_ALLOCATIONS=1),
+otherwise every function here is a no-op.
+Allocations are attributed to the innermost profiler zone and the address that called operator new,
+resolve the addresses of the report with addr2line -e main.exe.
+*/
+class AllocationTracker {
+public:
+    // Called by operator new, must not allocate
+    static void RecordAllocation(size_t size, void *caller);
+
+    // Closes the current frame, called once per main loop iteration
+    static void EndFrame();
+
+    static Uint64 GetTotalAllocations();
+    static Uint64 GetTotalBytes();
+
+    // Prints the worst frames and the top allocating sites
+    static void Report();
+};
+
+// Engine counters, see Counters
+enum Counter {
+    COUNTER_COLLISION_TESTS,
+    COUNTER_COLLISION_HITS,
+    COUNTER_DRAW_CALLS,
+    COUNTER_TEXTURE_SWITCHES,
+    COUNTER_SOUNDS_PLAYED,
+    COUNTER_VOICES_STOLEN,    // Sounds cut off to free a voice
+    COUNTER_SOUNDS_DROPPED,   // Sounds not played, every voice was more important
+    COUNTER_SOUNDS_COALESCED, // Requests merged into one already queued or just started
+    COUNTER_GET_COMPONENT,
+    COUNTER_OBJECTS_UPDATED,
+    COUNTER_OBJECTS_DRAWN,
+    COUNTER_AI_DECISIONS, // Decide jobs queued, see AIScheduler
+    COUNTER_COUNT
+};
+
+/*Per-frame engine counters, incremented on the hot paths.
+EndFrame moves the running values into a history ring, which DumpCsv writes out as a time series.
+Plain integers, only increment from the main thread.
+*/
+class Counters {
+private:
+    static const int HISTORY_LENGTH = 36000; // 10 minutes at 60 FPS
+
+    static int values[COUNTER_COUNT];
+    static int history[HISTORY_LENGTH][COUNTER_COUNT];
+    static Uint64 frameIndex;
+
+public:
+    static void Increment(Counter counter, int amount = 1) {
+        values[counter] += amount;
+    }
+
+    static void EndFrame();
+
+    // Values of the last finished frame
+    static int GetLastFrame(Counter counter);
+    static const char *GetName(Counter counter);
+
+    static bool DumpCsv(const std::string &path);
+};
+
+/*Log-linear histogram of durations in microseconds, in the style of HdrHistogram.
+Values below SUB_BUCKETS get their own bucket, above that every power of two is split into
+SUB_BUCKETS / 2 buckets, so any recorded value is off by at most ~3%. Values are clamped to MAX_VALUE.
+Fixed size, recording never allocates.
+*/
+class FrameTimeHistogram {
+public:
+    static const int SUB_BUCKETS = 64;
+    static const Uint32 MAX_VALUE = (1u << 24) - 1; // ~16.7 s
+    static const int BUCKET_COUNT = SUB_BUCKETS + (24 - 6) * (SUB_BUCKETS / 2);
+
+private:
+    Uint32 buckets[BUCKET_COUNT] = {0};
+    Uint64 count = 0;
+    Uint64 sum = 0;
+
+public:
+    static int GetBucket(Uint32 value);
+    // Middle of the range of values a bucket stands for
+    static Uint32 GetBucketValue(int bucket);
+
+    void Record(Uint32 value);
+    // Takes back a recorded value, used by the rolling window
+    void Remove(Uint32 value);
+    void Clear();
+
+    Uint64 GetCount() const { return count; }
+    Uint32 GetBucketCount(int bucket) const { return buckets[bucket]; }
+    double GetMean() const;
+    // percentile in [0, 100]
+    Uint32 GetPercentile(double percentile) const;
+    Uint32 GetMax() const;
+};
+
+// Parts of a frame timed by FrameStats
+enum FrameTimer {
+    FRAME_TOTAL,  // All the work of a frame, without the pacing wait
+    FRAME_SIM,    // Input, update and scene changes
+    FRAME_RENDER,
+    FRAME_TIMER_COUNT
+};
+
+/*Frame time distributions, for spotting stutters that an average FPS hides.
+Each timer keeps a histogram of the whole run and one of the last WINDOW_FRAMES frames for the overlay.
+Main thread only.
+*/
+class FrameStats {
+private:
+    static const int WINDOW_FRAMES = 600; // 10 seconds at 60 FPS
+
+    static FrameTimeHistogram total[FRAME_TIMER_COUNT];
+    static FrameTimeHistogram window[FRAME_TIMER_COUNT];
+    static Uint32 windowSamples[FRAME_TIMER_COUNT][WINDOW_FRAMES];
+    static Uint64 sampleCount[FRAME_TIMER_COUNT];
+
+public:
+    static void Record(FrameTimer timer, double milliseconds);
+
+    // In milliseconds, over the rolling window or the whole run
+    static double GetPercentile(FrameTimer timer, double percentile, bool rolling);
+    static double GetMax(FrameTimer timer, bool rolling);
+
+    static const char *GetName(FrameTimer timer);
+
+    // Prints the summary of the whole run
+    static void Report();
+    static bool DumpCsv(const std::string &path);
+    // Non-empty buckets of the whole run, for plotting and comparing builds
+    static bool DumpHistogramCsv(const std::string &path);
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+// detail is copied (truncated) into the event, e.g. an asset path
+#define PROFILE_ZONE_DETAIL(name, detail) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name, detail)
+
+#endif // PROFILER_HPP
@@ -0,0 +1,326 @@
+// Tunes the AI by self-play: plays parameter sets against the default AI and ranks them by goal difference.
+// Build and run with `make selfplay`, or `selfplay [--random=<sets>|--grid=<steps>] [--fields=<name>,...]
+// [--matches=<n>] [--jobs=<n>] [--seed=<n>] [--max-frames=<n>] [--game=<path>] [--out=<csv>]`.
+// Every match is a run of the game in --selfplay mode, the game keeps its state in singletons so matches are
+// separate processes, --jobs of them at a time (one per core by default), each deciding its AI on its main
+// thread. A set plays half its matches from each side, and every set plays the same kickoff seeds, so sets
+// only differ by their parameters.
+// The defaults are always the first set, its goal difference against itself is the noise floor.
+#include "AIParams.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+static const char *DEFAULT_GAME = "main.exe";
+#else
+static const char *DEFAULT_GAME = "./main";
+#endif
+
+// Larger grids have to be narrowed with --fields
+static const int MAX_GRID_SETS = 100000;
+
+struct ParameterSet {
+    AIParams params;
+
+    int goalsFor = 0, goalsAgainst = 0;
+    int wins = 0, draws = 0, losses = 0;
+    // Matches that didn't report a result
+    int failed = 0;
+
+    int GetGoalDifference() const {
+        return goalsFor - goalsAgainst;
+    }
+};
+
+struct Match {
+    int set = 0;
+    // Whether the set plays the left team
+    bool left = true;
+    unsigned int seed = 0;
+
+    bool finished = false;
+    int scoreLeft = 0, scoreRight = 0;
+};
+
+struct Options {
+    int randomSets = 0;
+    int gridSteps = 0;
+    std::vector<const AIParamField *> fields;
+    int matches = 4;
+    int jobs = 0;
+    unsigned int seed = 1;
+    int maxFrames = 36000;
+    std::string game = DEFAULT_GAME;
+    std::string out = "selfplay_results.csv";
+};
+
+// Reads "--name=value" into value, returns false if arg is a different option
+static bool ReadOption(const char *arg, const char *name, std::string &value) {
+    size_t length = strlen(name);
+    if (strncmp(arg, name, length) != 0 || arg[length] != '=')
+        return false;
+    value = arg + length + 1;
+    return true;
+}
+
+static bool ParseFields(const std::string &text, std::vector<const AIParamField *> &fields) {
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find(',', start);
+        if (end == std::string::npos)
+            end = text.size();
+
+        std::string name = text.substr(start, end - start);
+        if (!name.empty()) {
+            const AIParamField *field = FindAIParamField(name);
+            if (field == nullptr) {
+                std::cerr << "Unknown AI parameter: " << name << std::endl;
+                return false;
+            }
+            fields.push_back(field);
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+static bool ParseArguments(int argc, char *argv[], Options &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string value;
+        if (ReadOption(argv[i], "--random", value)) {
+            options.randomSets = atoi(value.c_str());
+        } else if (ReadOption(argv[i], "--grid", value)) {
+            options.gridSteps = atoi(value.c_str());
+        } else if (ReadOption(argv[i], "--fields", value)) {
+            if (!ParseFields(value, options.fields))
+                return false;
+        } else if (ReadOption(argv[i], "--matches", value)) {
+            options.matches = std::max(1, atoi(value.c_str()));
+        } else if (ReadOption(argv[i], "--jobs", value)) {
+            options.jobs = atoi(value.c_str());
+        } else if (ReadOption(argv[i], "--seed", value)) {
+            options.seed = (unsigned int)atoi(value.c_str());
+        } else if (ReadOption(argv[i], "--max-frames", value)) {
+            options.maxFrames = atoi(value.c_str());
+        } else if (ReadOption(argv[i], "--game", value)) {
+            options.game = value;
+        } else if (ReadOption(argv[i], "--out", value)) {
+            options.out = value;
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return false;
+        }
+    }
+
+    if (options.fields.empty()) {
+        for (int i = 0; i < AI_PARAM_FIELD_COUNT; i++) {
+            options.fields.push_back(&AI_PARAM_FIELDS[i]);
+        }
+    }
+    if (options.randomSets <= 0 && options.gridSteps <= 0)
+        options.randomSets = 32;
+    if (options.jobs <= 0)
+        options.jobs = std::max(1, SDL_GetCPUCount());
+    return true;
+}
+
+// Every combination of gridSteps values per field, evenly spaced over the field's range
+static bool AddGridSets(const Options &options, std::vector<ParameterSet> &sets) {
+    int steps = std::max(2, options.gridSteps);
+    double count = 1;
+    for (size_t i = 0; i < options.fields.size(); i++) {
+        count *= steps;
+    }
+    if (count > MAX_GRID_SETS) {
+        std::cerr << "Grid of " << count << " sets is too large, pick fewer parameters with --fields" << std::endl;
+        return false;
+    }
+
+    std::vector<int> index(options.fields.size(), 0);
+    for (int set = 0; set < (int)count; set++) {
+        ParameterSet parameters;
+        for (size_t i = 0; i < options.fields.size(); i++) {
+            const AIParamField *field = options.fields[i];
+            parameters.params.*(field->value) = field->min + (field->max - field->min) * index[i] / (steps - 1);
+        }
+        sets.push_back(parameters);
+
+        // Counts up like an odometer
+        for (size_t i = 0; i < index.size(); i++) {
+            if (++index[i] < steps)
+                break;
+            index[i] = 0;
+        }
+    }
+    return true;
+}
+
+static void AddRandomSets(const Options &options, std::vector<ParameterSet> &sets) {
+    std::mt19937 rng(options.seed);
+    for (int set = 0; set < options.randomSets; set++) {
+        ParameterSet parameters;
+        for (const AIParamField *field : options.fields) {
+            std::uniform_real_distribution<float> value(field->min, field->max);
+            parameters.params.*(field->value) = value(rng);
+        }
+        sets.push_back(parameters);
+    }
+}
+
+// Runs the game on one match and reads its result line
+static void PlayMatch(const Options &options, const std::vector<ParameterSet> &sets, Match &match) {
+    std::string params = FormatAIParams(sets[match.set].params);
+    std::string command = options.game + " --selfplay --seed=" + std::to_string(match.seed) +
+                          " --max-frames=" + std::to_string(options.maxFrames) +
+                          // The matches already fill the cores, AI workers would only wait to be scheduled
+                          " --ai-threads=0" +
+                          (match.left ? " --ai-params1=" : " --ai-params2=") + params + " 2>&1";
+
+    FILE *output = popen(command.c_str(), "r");
+    if (!output) {
+        std::cerr << "Failed to start: " << command << std::endl;
+        return;
+    }
+
+    char line[512];
+    while (fgets(line, sizeof(line), output)) {
+        int frames = 0;
+        if (sscanf(line, "SelfPlay result: %d - %d in %d frames", &match.scoreLeft, &match.scoreRight, &frames) == 3)
+            match.finished = true;
+    }
+    pclose(output);
+}
+
+static void WriteResults(const std::string &path, const std::vector<ParameterSet> &sets, const std::vector<int> &ranking) {
+    std::ofstream csv(path, std::ios::trunc);
+    if (!csv) {
+        std::cerr << "Failed to open results: " << path << std::endl;
+        return;
+    }
+
+    csv << "rank,set,goal_difference,goals_for,goals_against,wins,draws,losses,failed";
+    for (int i = 0; i < AI_PARAM_FIELD_COUNT; i++) {
+        csv << "," << AI_PARAM_FIELDS[i].name;
+    }
+    csv << "\n";
+
+    for (size_t rank = 0; rank < ranking.size(); rank++) {
+        const ParameterSet &set = sets[ranking[rank]];
+        csv << rank + 1 << "," << ranking[rank] << "," << set.GetGoalDifference() << "," << set.goalsFor << ","
+            << set.goalsAgainst << "," << set.wins << "," << set.draws << "," << set.losses << "," << set.failed;
+        for (int i = 0; i < AI_PARAM_FIELD_COUNT; i++) {
+            csv << "," << set.params.*(AI_PARAM_FIELDS[i].value);
+        }
+        csv << "\n";
+    }
+}
+
+int main(int argc, char *argv[]) {
+    Options options;
+    if (!ParseArguments(argc, argv, options)) {
+        std::cerr << "Usage: selfplay [--random=<sets>|--grid=<steps>] [--fields=<name>,...] [--matches=<n>] [--jobs=<n>]"
+                  << " [--seed=<n>] [--max-frames=<n>] [--game=<path>] [--out=<csv>]" << std::endl;
+        return 1;
+    }
+
+    std::vector<ParameterSet> sets(1);
+    if (options.gridSteps > 0) {
+        if (!AddGridSets(options, sets))
+            return 1;
+    } else {
+        AddRandomSets(options, sets);
+    }
+
+    std::vector<Match> matches;
+    for (int set = 0; set < (int)sets.size(); set++) {
+        for (int i = 0; i < options.matches; i++) {
+            Match match;
+            match.set = set;
+            match.left = i % 2 == 0;
+            // The same kickoffs for every set, a pair of matches per seed
+            match.seed = options.seed + i / 2;
+            matches.push_back(match);
+        }
+    }
+
+    std::cout << "Playing " << matches.size() << " matches for " << sets.size() << " parameter sets on "
+              << options.jobs << " jobs" << std::endl;
+
+    SDL_mutex *progressMutex = SDL_CreateMutex();
+    int done = 0, total = (int)matches.size();
+    {
+        ThreadPool pool("SelfPlay", options.jobs);
+        for (Match &match : matches) {
+            pool.Submit([&options, &sets, &match, &done, total, progressMutex]() {
+                PlayMatch(options, sets, match);
+
+                SDL_LockMutex(progressMutex);
+                done++;
+                if (done % 10 == 0 || done == total)
+                    std::cout << "  " << done << "/" << total << " matches" << std::endl;
+                SDL_UnlockMutex(progressMutex);
+            });
+        }
+        pool.Wait();
+    }
+    SDL_DestroyMutex(progressMutex);
+
+    for (const Match &match : matches) {
+        ParameterSet &set = sets[match.set];
+        if (!match.finished) {
+            set.failed++;
+            continue;
+        }
+
+        int scored = match.left ? match.scoreLeft : match.scoreRight;
+        int conceded = match.left ? match.scoreRight : match.scoreLeft;
+        set.goalsFor += scored;
+        set.goalsAgainst += conceded;
+        if (scored > conceded)
+            set.wins++;
+        else if (scored < conceded)
+            set.losses++;
+        else
+            set.draws++;
+    }
+
+    std::vector<int> ranking(sets.size());
+    for (size_t i = 0; i < ranking.size(); i++) {
+        ranking[i] = (int)i;
+    }
+    std::stable_sort(ranking.begin(), ranking.end(), [&sets](int a, int b) {
+        if (sets[a].GetGoalDifference() != sets[b].GetGoalDifference())
+            return sets[a].GetGoalDifference() > sets[b].GetGoalDifference();
+        return sets[a].goalsFor > sets[b].goalsFor;
+    });
+
+    int failed = 0;
+    for (const ParameterSet &set : sets) {
+        failed += set.failed;
+    }
+    if (failed > 0)
+        std::cerr << failed << " matches didn't report a result, is " << options.game << " built?" << std::endl;
+
+    std::cout << "Best sets against the defaults (set 0):" << std::endl;
+    for (size_t rank = 0; rank < ranking.size() && rank < 10; rank++) {
+        const ParameterSet &set = sets[ranking[rank]];
+        std::cout << "  " << rank + 1 << ". set " << ranking[rank] << ": " << (set.GetGoalDifference() >= 0 ? "+" : "")
+                  << set.GetGoalDifference() << " (" << set.goalsFor << "-" << set.goalsAgainst << ", W" << set.wins
+                  << " D" << set.draws << " L" << set.losses << ") " << FormatAIParams(set.params) << std::endl;
+    }
+
+    WriteResults(options.out, sets, ranking);
+    std::cout << "Results written to " << options.out << std::endl;
+    return failed == (int)matches.size() ? 1 : 0;
+}
@@ -0,0 +1,123 @@
+// Converts images to pre-decoded texture blobs, see TextureBlob.hpp.
+// Build and run with `make textures`, or `texconv [--raw] <file|directory>...`.
+// Each image gets its blob next to it (yard.png -> yard.png.tex), the game loads the blob instead
+// while it is at least as new as the image. Directories are converted recursively, PNGs only:
+// the raw pixels of a photo are many times the size of its JPEG, name JPEGs explicitly to convert them anyway.
+#include "TextureBlob.hpp"
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <dirent.h>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+static bool compress = true;
+static int converted = 0, failed = 0;
+
+static bool IsImage(const std::string &name) {
+    size_t dot = name.find_last_of('.');
+    if (dot == std::string::npos)
+        return false;
+
+    std::string extension = name.substr(dot + 1);
+    for (char &c : extension) {
+        c = (char)tolower((unsigned char)c);
+    }
+    return extension == "png";
+}
+
+static void Convert(const std::string &path) {
+    SDL_Surface *image = IMG_Load(path.c_str());
+    if (!image) {
+        std::cerr << "Failed to load image: " << path << ": " << IMG_GetError() << std::endl;
+        failed++;
+        return;
+    }
+
+    std::string blobPath = GetTextureBlobPath(path);
+    if (WriteTextureBlob(blobPath, image, compress)) {
+        struct stat info;
+        long long size = stat(blobPath.c_str(), &info) == 0 ? (long long)info.st_size : 0;
+        std::cout << blobPath << " (" << image->w << "x" << image->h << ", " << size << " bytes)" << std::endl;
+        converted++;
+    } else {
+        failed++;
+    }
+
+    SDL_FreeSurface(image);
+}
+
+static void ConvertPath(const std::string &path) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        std::cerr << "No such file or directory: " << path << std::endl;
+        failed++;
+        return;
+    }
+
+    if (!S_ISDIR(info.st_mode)) {
+        Convert(path);
+        return;
+    }
+
+    DIR *dir = opendir(path.c_str());
+    if (!dir) {
+        std::cerr << "Failed to open directory: " << path << std::endl;
+        failed++;
+        return;
+    }
+
+    std::vector<std::string> names;
+    while (dirent *entry = readdir(dir)) {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+            names.push_back(entry->d_name);
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+
+    for (auto &name : names) {
+        std::string child = path + "/" + name;
+        if (stat(child.c_str(), &info) != 0)
+            continue;
+        if (S_ISDIR(info.st_mode))
+            ConvertPath(child);
+        else if (IsImage(name))
+            Convert(child);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--raw") == 0)
+            compress = false;
+        else
+            paths.push_back(argv[i]);
+    }
+
+    if (paths.empty()) {
+        std::cerr << "Usage: texconv [--raw] <file|directory>..." << std::endl;
+        return 1;
+    }
+
+    if (SDL_Init(0) != 0) {
+        std::cerr << "Failed to initialise SDL: " << SDL_GetError() << std::endl;
+        return 1;
+    }
+    IMG_Init(IMG_INIT_JPG | IMG_INIT_PNG);
+
+    for (auto &path : paths) {
+        ConvertPath(path);
+    }
+
+    std::cout << "Converted " << converted << " images, " << failed << " failed" << std::endl;
+
+    IMG_Quit();
+    SDL_Quit();
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,288 @@
+#include "TextureBlob.hpp"
+#include "Profiler.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#pragma region LZ4
+
+static const int LZ4_MIN_MATCH = 4;
+// The last match has to start this far from the end and the last bytes are always literals
+static const int LZ4_MATCH_FIND_LIMIT = 12;
+static const int LZ4_LAST_LITERALS = 5;
+static const int LZ4_MAX_OFFSET = 65535;
+static const int LZ4_HASH_BITS = 12;
+
+static Uint32 Read32(const Uint8 *data) {
+    Uint32 value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static int Lz4Hash(Uint32 sequence) {
+    return (int)((sequence * 2654435761u) >> (32 - LZ4_HASH_BITS));
+}
+
+// Length continuation bytes after a saturated token nibble
+static bool Lz4WriteLength(int length, Uint8 *&op, const Uint8 *opEnd) {
+    while (length >= 255) {
+        if (op >= opEnd)
+            return false;
+        *op++ = 255;
+        length -= 255;
+    }
+    if (op >= opEnd)
+        return false;
+    *op++ = (Uint8)length;
+    return true;
+}
+
+static bool Lz4WriteSequence(const Uint8 *literals, int literalLength, int offset, int matchLength, Uint8 *&op, const Uint8 *opEnd) {
+    if (op >= opEnd)
+        return false;
+    Uint8 *token = op++;
+    *token = (Uint8)((literalLength >= 15 ? 15 : literalLength) << 4);
+    if (literalLength >= 15 && !Lz4WriteLength(literalLength - 15, op, opEnd))
+        return false;
+
+    if (opEnd - op < literalLength)
+        return false;
+    memcpy(op, literals, literalLength);
+    op += literalLength;
+
+    // The last sequence only has literals
+    if (matchLength == 0)
+        return true;
+
+    if (opEnd - op < 2)
+        return false;
+    *op++ = (Uint8)(offset & 0xFF);
+    *op++ = (Uint8)(offset >> 8);
+
+    int length = matchLength - LZ4_MIN_MATCH;
+    *token |= (Uint8)(length >= 15 ? 15 : length);
+    if (length >= 15 && !Lz4WriteLength(length - 15, op, opEnd))
+        return false;
+
+    return true;
+}
+
+int Lz4CompressBound(int size) {
+    return size + size / 255 + 16;
+}
+
+int Lz4Compress(const Uint8 *src, int srcSize, Uint8 *dst, int dstCapacity) {
+    Uint8 *op = dst;
+    const Uint8 *opEnd = dst + dstCapacity;
+
+    // Greedy matching against the last position seen with the same hash
+    int table[1 << LZ4_HASH_BITS];
+    for (int &entry : table) {
+        entry = -1;
+    }
+
+    int anchor = 0;
+    int position = 0;
+    int findLimit = srcSize - LZ4_MATCH_FIND_LIMIT;
+    int matchLimit = srcSize - LZ4_LAST_LITERALS;
+
+    while (position < findLimit) {
+        Uint32 sequence = Read32(src + position);
+        int hash = Lz4Hash(sequence);
+        int candidate = table[hash];
+        table[hash] = position;
+
+        if (candidate < 0 || position - candidate > LZ4_MAX_OFFSET || Read32(src + candidate) != sequence) {
+            position++;
+            continue;
+        }
+
+        int length = LZ4_MIN_MATCH;
+        while (position + length < matchLimit && src[candidate + length] == src[position + length]) {
+            length++;
+        }
+
+        if (!Lz4WriteSequence(src + anchor, position - anchor, position - candidate, length, op, opEnd))
+            return 0;
+
+        position += length;
+        anchor = position;
+    }
+
+    if (!Lz4WriteSequence(src + anchor, srcSize - anchor, 0, 0, op, opEnd))
+        return 0;
+
+    return (int)(op - dst);
+}
+
+int Lz4Decompress(const Uint8 *src, int srcSize, Uint8 *dst, int dstSize) {
+    const Uint8 *ip = src;
+    const Uint8 *ipEnd = src + srcSize;
+    Uint8 *op = dst;
+    Uint8 *opEnd = dst + dstSize;
+
+    while (ip < ipEnd) {
+        Uint8 token = *ip++;
+
+        int literalLength = token >> 4;
+        if (literalLength == 15) {
+            Uint8 extra;
+            do {
+                if (ip >= ipEnd)
+                    return -1;
+                extra = *ip++;
+                literalLength += extra;
+            } while (extra == 255);
+        }
+
+        if (ipEnd - ip < literalLength || opEnd - op < literalLength)
+            return -1;
+        memcpy(op, ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+
+        if (ip == ipEnd)
+            break;
+
+        if (ipEnd - ip < 2)
+            return -1;
+        int offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > op - dst)
+            return -1;
+
+        int matchLength = token & 15;
+        if (matchLength == 15) {
+            Uint8 extra;
+            do {
+                if (ip >= ipEnd)
+                    return -1;
+                extra = *ip++;
+                matchLength += extra;
+            } while (extra == 255);
+        }
+        matchLength += LZ4_MIN_MATCH;
+
+        if (opEnd - op < matchLength)
+            return -1;
+
+        // Byte by byte, the match may overlap the bytes it produces
+        const Uint8 *match = op - offset;
+        for (int i = 0; i < matchLength; i++) {
+            op[i] = match[i];
+        }
+        op += matchLength;
+    }
+
+    return (int)(op - dst);
+}
+
+#pragma endregion
+
+#pragma region TextureBlob
+
+std::string GetTextureBlobPath(const std::string &imagePath) {
+    return imagePath + TEXTURE_BLOB_EXTENSION;
+}
+
+bool WriteTextureBlob(const std::string &path, SDL_Surface *surface, bool compress) {
+    SDL_Surface *converted = SDL_ConvertSurfaceFormat(surface, TEXTURE_BLOB_FORMAT, 0);
+    if (!converted) {
+        std::cerr << "Failed to convert surface: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    // Rows tightly packed, the surface pitch may have padding
+    int rowSize = converted->w * 4;
+    std::vector<Uint8> pixels((size_t)rowSize * converted->h);
+    for (int y = 0; y < converted->h; y++) {
+        memcpy(pixels.data() + (size_t)y * rowSize, (Uint8 *)converted->pixels + y * converted->pitch, rowSize);
+    }
+
+    Uint32 width = converted->w, height = converted->h;
+    SDL_FreeSurface(converted);
+
+    Uint32 compression = TEXTURE_BLOB_RAW;
+    std::vector<Uint8> data;
+    if (compress) {
+        data.resize(Lz4CompressBound((int)pixels.size()));
+        int compressedSize = Lz4Compress(pixels.data(), (int)pixels.size(), data.data(), (int)data.size());
+        if (compressedSize > 0 && compressedSize < (int)pixels.size()) {
+            data.resize(compressedSize);
+            compression = TEXTURE_BLOB_LZ4;
+        }
+    }
+    if (compression == TEXTURE_BLOB_RAW)
+        data.swap(pixels);
+
+    SDL_RWops *rw = SDL_RWFromFile(path.c_str(), "wb");
+    if (!rw) {
+        std::cerr << "Failed to create texture blob: " << path << ": " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    bool written = SDL_RWwrite(rw, TEXTURE_BLOB_MAGIC, 4, 1) == 1 &&
+                   SDL_WriteLE32(rw, TEXTURE_BLOB_VERSION) && SDL_WriteLE32(rw, width) && SDL_WriteLE32(rw, height) &&
+                   SDL_WriteLE32(rw, TEXTURE_BLOB_FORMAT) && SDL_WriteLE32(rw, compression) &&
+                   SDL_WriteLE32(rw, (Uint32)data.size()) &&
+                   SDL_RWwrite(rw, data.data(), 1, data.size()) == data.size();
+    SDL_RWclose(rw);
+
+    if (!written)
+        std::cerr << "Failed to write texture blob: " << path << std::endl;
+    return written;
+}
+
+SDL_Surface *ReadTextureBlob(SDL_RWops *rw) {
+    if (!rw)
+        return nullptr;
+    PROFILE_ZONE("ReadTextureBlob");
+
+    TextureBlobHeader header;
+    bool valid = SDL_RWread(rw, header.magic, 4, 1) == 1 && memcmp(header.magic, TEXTURE_BLOB_MAGIC, 4) == 0;
+    if (valid) {
+        header.version = SDL_ReadLE32(rw);
+        header.width = SDL_ReadLE32(rw);
+        header.height = SDL_ReadLE32(rw);
+        header.format = SDL_ReadLE32(rw);
+        header.compression = SDL_ReadLE32(rw);
+        header.dataSize = SDL_ReadLE32(rw);
+        valid = header.version == TEXTURE_BLOB_VERSION && header.format == TEXTURE_BLOB_FORMAT &&
+                header.width > 0 && header.height > 0 && header.width <= 16384 && header.height <= 16384;
+    }
+    if (valid) {
+        // A damaged header mustn't allocate more than the file holds or the pixels could compress to
+        Sint64 fileSize = SDL_RWsize(rw);
+        Sint64 available = fileSize < 0 ? -1 : fileSize - SDL_RWtell(rw);
+        valid = header.dataSize <= (Uint32)Lz4CompressBound((int)(header.width * header.height * 4)) &&
+                (available < 0 || header.dataSize <= (Uint64)available);
+    }
+
+    SDL_Surface *surface = nullptr;
+    if (valid)
+        surface = SDL_CreateRGBSurfaceWithFormat(0, header.width, header.height, 32, header.format);
+
+    if (surface) {
+        int size = (int)(header.width * header.height * 4);
+        if (header.compression == TEXTURE_BLOB_RAW) {
+            valid = header.dataSize == (Uint32)size && SDL_RWread(rw, surface->pixels, 1, size) == (size_t)size;
+        } else if (header.compression == TEXTURE_BLOB_LZ4) {
+            std::vector<Uint8> data(header.dataSize);
+            valid = SDL_RWread(rw, data.data(), 1, data.size()) == data.size() &&
+                    Lz4Decompress(data.data(), (int)data.size(), (Uint8 *)surface->pixels, size) == size;
+        } else {
+            valid = false;
+        }
+
+        if (!valid) {
+            SDL_FreeSurface(surface);
+            surface = nullptr;
+        }
+    }
+
+    SDL_RWclose(rw);
+    return surface;
+}
+
+#pragma endregion
@@ -0,0 +1,49 @@
+#ifndef TEXTUREBLOB_HPP
+#define TEXTUREBLOB_HPP
+
+#include <SDL2/SDL.h>
+#include <string>
+
+/*Pre-decoded texture format, written offline by TexConv.cpp so startup skips libpng and libjpeg.
+A TextureBlobHeader followed by dataSize bytes of pixels, rows tightly packed (pitch = width * 4),
+either raw or as one LZ4 block. All integers little-endian.
+Pixels are stored in TEXTURE_BLOB_FORMAT, what the renderers take without converting.
+*/
+#define TEXTURE_BLOB_MAGIC "RTEX"
+#define TEXTURE_BLOB_EXTENSION ".tex"
+const Uint32 TEXTURE_BLOB_VERSION = 1;
+const Uint32 TEXTURE_BLOB_FORMAT = SDL_PIXELFORMAT_ARGB8888;
+
+enum TextureBlobCompression {
+    TEXTURE_BLOB_RAW,
+    TEXTURE_BLOB_LZ4
+};
+
+struct TextureBlobHeader {
+    char magic[4];
+    Uint32 version;
+    Uint32 width;
+    Uint32 height;
+    Uint32 format;      // SDL_PixelFormatEnum
+    Uint32 compression; // TextureBlobCompression
+    Uint32 dataSize;
+};
+
+// Where the converted version of an image is kept, next to the image itself
+std::string GetTextureBlobPath(const std::string &imagePath);
+
+// Writes surface as a blob, LZ4 compressed if that saves space. Returns false if the file could not be written.
+bool WriteTextureBlob(const std::string &path, SDL_Surface *surface, bool compress);
+// Reads a blob into a new surface in the stored format and closes rw. nullptr if rw isn't a valid blob.
+// Doesn't touch the renderer, safe from worker threads.
+SDL_Surface *ReadTextureBlob(SDL_RWops *rw);
+
+/*LZ4 block format (no frame), enough of it for the blobs.
+Compress returns the compressed size, or 0 if the result would not fit in dstCapacity.
+Decompress returns the number of bytes written, or -1 if src is malformed or doesn't fit in dstSize.
+*/
+int Lz4CompressBound(int size);
+int Lz4Compress(const Uint8 *src, int srcSize, Uint8 *dst, int dstCapacity);
+int Lz4Decompress(const Uint8 *src, int srcSize, Uint8 *dst, int dstSize);
+
+#endif // TEXTUREBLOB_HPP
@@ -0,0 +1,105 @@
+#include "ThreadPool.hpp"
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+ThreadPool::ThreadPool(const char *name, int threadCount) {
+    if (threadCount < 0)
+        threadCount = std::max(1, SDL_GetCPUCount() - 1);
+
+    mutex = SDL_CreateMutex();
+    taskAvailable = SDL_CreateCond();
+    idle = SDL_CreateCond();
+
+    for (int i = 0; i < threadCount; i++) {
+        std::string threadName = std::string(name) + std::to_string(i);
+        SDL_Thread *thread = SDL_CreateThread(WorkerMain, threadName.c_str(), this);
+        if (!thread) {
+            std::cerr << "Failed to create worker thread: " << SDL_GetError() << std::endl;
+            continue;
+        }
+        threads.push_back(thread);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    SDL_LockMutex(mutex);
+    stopping = true;
+    tasks.clear();
+    SDL_CondBroadcast(taskAvailable);
+    SDL_UnlockMutex(mutex);
+
+    for (auto &thread : threads) {
+        SDL_WaitThread(thread, nullptr);
+    }
+    threads.clear();
+
+    SDL_DestroyCond(idle);
+    SDL_DestroyCond(taskAvailable);
+    SDL_DestroyMutex(mutex);
+}
+
+int ThreadPool::WorkerMain(void *data) {
+    ThreadPool *pool = (ThreadPool *)data;
+
+    SDL_LockMutex(pool->mutex);
+    while (true) {
+        while (pool->tasks.empty() && !pool->stopping) {
+            SDL_CondWait(pool->taskAvailable, pool->mutex);
+        }
+        if (pool->stopping)
+            break;
+
+        std::function<void()> task = std::move(pool->tasks.front());
+        pool->tasks.pop_front();
+        pool->runningTasks++;
+        SDL_UnlockMutex(pool->mutex);
+
+        {
+            PROFILE_ZONE("Task");
+            task();
+        }
+
+        SDL_LockMutex(pool->mutex);
+        pool->runningTasks--;
+        if (pool->tasks.empty() && pool->runningTasks == 0)
+            SDL_CondBroadcast(pool->idle);
+    }
+    SDL_UnlockMutex(pool->mutex);
+
+    return 0;
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    // Without workers, asked for or failed to start, the task runs right away
+    if (threads.empty()) {
+        task();
+        return;
+    }
+
+    SDL_LockMutex(mutex);
+    tasks.push_back(std::move(task));
+    SDL_CondSignal(taskAvailable);
+    SDL_UnlockMutex(mutex);
+}
+
+void ThreadPool::Wait() {
+    SDL_LockMutex(mutex);
+    while (!tasks.empty() || runningTasks > 0) {
+        SDL_CondWait(idle, mutex);
+    }
+    SDL_UnlockMutex(mutex);
+}
+
+int ThreadPool::GetThreadCount() const {
+    return (int)threads.size();
+}
+
+int ThreadPool::GetPendingCount() {
+    SDL_LockMutex(mutex);
+    int pending = (int)tasks.size() + runningTasks;
+    SDL_UnlockMutex(mutex);
+    return pending;
+}
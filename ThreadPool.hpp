@@ -0,0 +1,46 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <SDL2/SDL.h>
+#include <deque>
+#include <functional>
+#include <vector>
+
+/*Fixed set of worker threads running queued tasks in submission order.
+Uses SDL threads and locks, the MinGW toolchain the game is built with has no std::thread.
+Tasks must not touch the renderer or the game objects, hand results back to the main thread instead.
+*/
+class ThreadPool {
+private:
+    std::vector<SDL_Thread *> threads;
+    std::deque<std::function<void()>> tasks;
+
+    SDL_mutex *mutex = nullptr;
+    SDL_cond *taskAvailable = nullptr;
+    SDL_cond *idle = nullptr;
+
+    int runningTasks = 0;
+    bool stopping = false;
+
+    static int WorkerMain(void *data);
+
+public:
+    // One thread per core besides the main thread, at least one
+    static const int AUTO_THREAD_COUNT = -1;
+
+    // With a threadCount of 0 there are no workers and Submit runs every task on the calling thread
+    ThreadPool(const char *name, int threadCount = AUTO_THREAD_COUNT);
+    // Tasks that haven't started are dropped, running ones are waited for
+    ~ThreadPool();
+
+    void Submit(std::function<void()> task);
+
+    // Blocks until every submitted task has finished
+    void Wait();
+
+    int GetThreadCount() const;
+    // Tasks queued or running
+    int GetPendingCount();
+};
+
+#endif // THREADPOOL_HPP
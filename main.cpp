@@ -1,31 +1,150 @@
+#include "CustomClasses.hpp"
+#include "FramePacer.hpp"
 #include "Game.hpp"
 #include "Global.hpp"
+#include "Profiler.hpp"
 #include <SDL2/SDL.h>
 
 #include <iostream>
 #include <cstring>
+#include <cstdlib>
+#include <string>
 
 Game *game = nullptr;
 
+// Reads "--name=value" into value, returns false if arg is a different option
+static bool ReadIntOption(const char *arg, const char *name, int &value) {
+    size_t length = strlen(name);
+    if (strncmp(arg, name, length) != 0 || arg[length] != '=')
+        return false;
+    value = atoi(arg + length + 1);
+    return true;
+}
+
+// Reads "--name=value" into value, for options that aren't numbers
+static bool ReadStringOption(const char *arg, const char *name, std::string &value) {
+    size_t length = strlen(name);
+    if (strncmp(arg, name, length) != 0 || arg[length] != '=')
+        return false;
+    value = arg + length + 1;
+    return true;
+}
+
+// False if an option can't be used, e.g. malformed AI parameters
+static bool ParseArguments(int argc, char *argv[]) {
+    Game::StressConfig &config = game->stressConfig;
+    int seed = (int)config.seed;
+    int angleCount = 0;
+    std::string aiParams;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--stress") == 0) {
+            game->stressMode = true;
+        } else if (strcmp(arg, "--headless") == 0) {
+            game->headless = true;
+        } else if (strcmp(arg, "--selfplay") == 0) {
+            game->selfPlayMode = true;
+            game->headless = true;
+        } else if (ReadStringOption(arg, "--ai-params1", aiParams)) {
+            if (!ParseAIParams(aiParams, game->aiParams[0]))
+                return false;
+        } else if (ReadStringOption(arg, "--ai-params2", aiParams)) {
+            if (!ParseAIParams(aiParams, game->aiParams[1]))
+                return false;
+        } else if (ReadIntOption(arg, "--max-frames", game->selfPlayConfig.maxFrames)) {
+        } else if (ReadIntOption(arg, "--ai-threads", Game::aiThreadCount)) {
+        } else if (strcmp(arg, "--prerotate") == 0) {
+            RotatedSpriteCache::GetInstance()->SetAngleCount(32);
+        } else if (ReadIntOption(arg, "--prerotate", angleCount)) {
+            RotatedSpriteCache::GetInstance()->SetAngleCount(angleCount);
+        } else if (ReadIntOption(arg, "--players", config.players) ||
+                   ReadIntOption(arg, "--balls", config.balls) ||
+                   ReadIntOption(arg, "--walls", config.walls) ||
+                   ReadIntOption(arg, "--sprites", config.decorations) ||
+                   ReadIntOption(arg, "--steps", config.steps) ||
+                   ReadIntOption(arg, "--frames", config.framesPerStep) ||
+                   ReadIntOption(arg, "--seed", seed)) {
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+        }
+    }
+
+    config.seed = (unsigned int)seed;
+    game->selfPlayConfig.seed = (unsigned int)seed;
+    return true;
+}
+
 int main(int argc, char *argv[]) {
+    // Start the trace clock before the first zone opens
+    TraceRecorder::GetInstance();
+
     game = new Game();
+    // A self-play match with parameters it can't read must fail instead of playing the defaults
+    if (!ParseArguments(argc, argv)) {
+        delete game;
+        return 1;
+    }
 
     game->init("Game Window", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, WIDTH, HEIGHT, FULLSCREEN);
 
+    double counterToMs = 1000.0 / (double)SDL_GetPerformanceFrequency();
+    FramePacer pacer(FPS, game->vsync);
+
     while (game->running()) {
+        // Static scenes sleep until there is something to do, the wait isn't part of the frame
+        if (game->canIdle()) {
+            game->waitForInput();
+            pacer.Reset();
+        }
+
+        PROFILE_ZONE("Frame");
+        Uint64 frameStart = SDL_GetPerformanceCounter();
+
         if (game->reseting()){
             game->clean();
             game->init("Game Window", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, WIDTH, HEIGHT, FULLSCREEN);
+            pacer.SetVSync(game->vsync);
         }
         game->handleEvents();
         game->update();
-        game->render();
-        
+        Uint64 renderStart = SDL_GetPerformanceCounter();
+        if (!game->headless)
+            game->render();
+        Uint64 renderEnd = SDL_GetPerformanceCounter();
+
         game->handleSceneChange();
-        SDL_Delay(1000 / FPS);
+        // Sounds requested during the frame, including by the scene just loaded
+        SoundManager::GetInstance()->Flush();
+
+        Uint64 frameEnd = SDL_GetPerformanceCounter();
+        Game::frameTime = (float)((frameEnd - frameStart) * counterToMs);
+
+        FrameStats::Record(FRAME_TOTAL, Game::frameTime);
+        FrameStats::Record(FRAME_SIM, (double)(frameEnd - frameStart - (renderEnd - renderStart)) * counterToMs);
+        if (!game->headless)
+            FrameStats::Record(FRAME_RENDER, (double)(renderEnd - renderStart) * counterToMs);
+
+        if (!game->headless)
+            pacer.Wait();
+
+        AllocationTracker::EndFrame();
+        Counters::EndFrame();
     }
 
     game->clean();
 
+    // Self-play runs side by side in one directory, only the result line matters
+    if (game->selfPlayMode)
+        return 0;
+
+    pacer.Report();
+    FrameStats::Report();
+    FrameStats::DumpCsv("frame_stats.csv");
+    FrameStats::DumpHistogramCsv("frame_histogram.csv");
+    TraceRecorder::GetInstance()->Dump("trace.json");
+    AllocationTracker::Report();
+    Counters::DumpCsv("counters.csv");
+
     return 0;
-}
\ No newline at end of file
+}